@@ -0,0 +1,320 @@
+// Completely Fair Scheduler policy for the event engine
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include "process.h"
+#include "sim.h"
+#include "cfs.h"
+
+// Weights of nice -20 to 19, each step about 10% of CPU apart
+static const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+/* Red-black tree of process indexes with the nodes in arrays. Index n is
+ * the black sentinel that stands in for every missing child. */
+typedef struct cfs_tree {
+    int *left;
+    int *right;
+    int *parent;
+    char *red;
+    long long *key;
+    int root;
+    int nil;
+    int count;
+}CfsTree;
+
+typedef struct cfs {
+    CfsConfig *cfg;
+    CfsTree tree;
+    long long *vruntime;
+    long long *charged;        // rem when its CPU time was last counted
+    int *weight;
+    char *started;             // has been ready before
+    long long queued_weight;   // of the processes in the tree
+    long long min_vruntime;    // never decreases
+    long long requeues;
+}CfsState;
+
+void cfs_default_config(CfsConfig *c)
+{
+    c->latency = 24;
+    c->granularity = 3;
+}
+
+int cfs_parse_option(CfsConfig *c, char *arg)
+{
+    char *end;
+
+    if (strncmp(arg, "-LATENCY=", 9) == 0) {
+        c->latency = (int)strtol(arg + 9, &end, 10);
+        return *end == '\0' && c->latency > 0 ? 1 : -1;
+    }
+    if (strncmp(arg, "-GRANULARITY=", 13) == 0) {
+        c->granularity = (int)strtol(arg + 13, &end, 10);
+        return *end == '\0' && c->granularity > 0 ? 1 : -1;
+    }
+    return 0;
+}
+
+int cfs_weight(int pri)
+{
+    int nice = -pri;
+
+    if (nice < -20) nice = -20;
+    if (nice > 19) nice = 19;
+    return nice_to_weight[nice + 20];
+}
+
+static int before(CfsTree *t, int a, int b)
+{
+    if (t->key[a] != t->key[b]) return t->key[a] < t->key[b];
+    return a < b;
+}
+
+static void rotate_left(CfsTree *t, int x)
+{
+    int y = t->right[x];
+
+    t->right[x] = t->left[y];
+    if (t->left[y] != t->nil) t->parent[t->left[y]] = x;
+    t->parent[y] = t->parent[x];
+    if (t->parent[x] == t->nil) t->root = y;
+    else if (x == t->left[t->parent[x]]) t->left[t->parent[x]] = y;
+    else t->right[t->parent[x]] = y;
+    t->left[y] = x;
+    t->parent[x] = y;
+}
+
+static void rotate_right(CfsTree *t, int x)
+{
+    int y = t->left[x];
+
+    t->left[x] = t->right[y];
+    if (t->right[y] != t->nil) t->parent[t->right[y]] = x;
+    t->parent[y] = t->parent[x];
+    if (t->parent[x] == t->nil) t->root = y;
+    else if (x == t->right[t->parent[x]]) t->right[t->parent[x]] = y;
+    else t->left[t->parent[x]] = y;
+    t->right[y] = x;
+    t->parent[x] = y;
+}
+
+static void tree_insert(CfsTree *t, int z)
+{
+    int x = t->root, y = t->nil, p, g, u;
+
+    while (x != t->nil) {
+        y = x;
+        x = before(t, z, x) ? t->left[x] : t->right[x];
+    }
+    t->parent[z] = y;
+    if (y == t->nil) t->root = z;
+    else if (before(t, z, y)) t->left[y] = z;
+    else t->right[y] = z;
+    t->left[z] = t->right[z] = t->nil;
+    t->red[z] = 1;
+    t->count++;
+
+    while (t->red[p = t->parent[z]]) {
+        g = t->parent[p];
+        if (p == t->left[g]) {
+            u = t->right[g];
+            if (t->red[u]) {
+                t->red[p] = t->red[u] = 0;
+                t->red[g] = 1;
+                z = g;
+                continue;
+            }
+            if (z == t->right[p]) {
+                z = p;
+                rotate_left(t, z);
+                p = t->parent[z];
+            }
+            t->red[p] = 0;
+            t->red[g] = 1;
+            rotate_right(t, g);
+        }
+        else {
+            u = t->left[g];
+            if (t->red[u]) {
+                t->red[p] = t->red[u] = 0;
+                t->red[g] = 1;
+                z = g;
+                continue;
+            }
+            if (z == t->left[p]) {
+                z = p;
+                rotate_right(t, z);
+                p = t->parent[z];
+            }
+            t->red[p] = 0;
+            t->red[g] = 1;
+            rotate_left(t, g);
+        }
+    }
+    t->red[t->root] = 0;
+}
+
+// Removes and returns the leftmost process, -1 when the tree is empty
+static int tree_pop_min(CfsTree *t)
+{
+    int z = t->root, x, p, w;
+
+    if (z == t->nil) return -1;
+    while (t->left[z] != t->nil) z = t->left[z];
+
+    // z has no left child: its right child takes its place
+    x = t->right[z];
+    p = t->parent[z];
+    t->parent[x] = p;
+    if (p == t->nil) t->root = x;
+    else t->left[p] = x;
+    t->count--;
+    if (t->red[z]) return z;
+
+    while (x != t->root && !t->red[x]) {
+        p = t->parent[x];
+        if (x == t->left[p]) {
+            w = t->right[p];
+            if (t->red[w]) {
+                t->red[w] = 0;
+                t->red[p] = 1;
+                rotate_left(t, p);
+                w = t->right[p];
+            }
+            if (!t->red[t->left[w]] && !t->red[t->right[w]]) {
+                t->red[w] = 1;
+                x = p;
+                continue;
+            }
+            if (!t->red[t->right[w]]) {
+                t->red[t->left[w]] = 0;
+                t->red[w] = 1;
+                rotate_right(t, w);
+                w = t->right[p];
+            }
+            t->red[w] = t->red[p];
+            t->red[p] = 0;
+            t->red[t->right[w]] = 0;
+            rotate_left(t, p);
+        }
+        else {
+            w = t->left[p];
+            if (t->red[w]) {
+                t->red[w] = 0;
+                t->red[p] = 1;
+                rotate_right(t, p);
+                w = t->left[p];
+            }
+            if (!t->red[t->left[w]] && !t->red[t->right[w]]) {
+                t->red[w] = 1;
+                x = p;
+                continue;
+            }
+            if (!t->red[t->left[w]]) {
+                t->red[t->right[w]] = 0;
+                t->red[w] = 1;
+                rotate_left(t, w);
+                w = t->left[p];
+            }
+            t->red[w] = t->red[p];
+            t->red[p] = 0;
+            t->red[t->left[w]] = 0;
+            rotate_right(t, p);
+        }
+        x = t->root;
+    }
+    t->red[x] = 0;
+    return z;
+}
+
+static void readyCfs(SimType *s, int i)
+{
+    CfsState *m = s->policy->data;
+
+    if (!m->started[i]) {
+        m->started[i] = 1;
+        if (m->vruntime[i] < m->min_vruntime) m->vruntime[i] = m->min_vruntime;
+    }
+    else {
+        m->vruntime[i] += ((m->charged[i] - s->rem[i]) << CFS_VRUNTIME_SHIFT) / m->weight[i];
+        m->charged[i] = s->rem[i];
+        m->requeues++;
+    }
+    tree_insert(&m->tree, i);
+    m->queued_weight += m->weight[i];
+}
+
+static int nextCfs(SimType *s)
+{
+    CfsState *m = s->policy->data;
+    int i = tree_pop_min(&m->tree);
+    long long period = m->cfg->latency, slice;
+
+    if (i == -1) return -1;
+    if (m->vruntime[i] > m->min_vruntime) m->min_vruntime = m->vruntime[i];
+
+    if ((long long)(m->tree.count + 1) * m->cfg->granularity > period)
+        period = (long long)(m->tree.count + 1) * m->cfg->granularity;
+    slice = period * m->weight[i] / m->queued_weight;
+    m->queued_weight -= m->weight[i];
+    s->slice = slice < m->cfg->granularity ? m->cfg->granularity : (int)slice;
+    return i;
+}
+
+long long findWaitingTimeCFS(ProcessType plist[], int n, CfsConfig *c, TimelineType *tl)
+{
+    SimPolicy cfs = { readyCfs, nextCfs, 0, NULL, NULL };
+    CfsState m;
+    SimType sim;
+    int i;
+
+    m.cfg = c;
+    m.tree.left = malloc((n + 1) * sizeof(int));
+    m.tree.right = malloc((n + 1) * sizeof(int));
+    m.tree.parent = malloc((n + 1) * sizeof(int));
+    m.tree.red = calloc(n + 1, sizeof(char));
+    m.vruntime = calloc(n + 1, sizeof(long long));
+    m.tree.key = m.vruntime;
+    m.tree.nil = n;
+    m.tree.root = n;
+    m.tree.count = 0;
+    m.charged = malloc((n + 1) * sizeof(long long));
+    m.weight = malloc((n + 1) * sizeof(int));
+    m.started = calloc(n + 1, sizeof(char));
+    m.queued_weight = 0;
+    m.min_vruntime = 0;
+    m.requeues = 0;
+    for (i = 0; i < n; i++) {
+        m.charged[i] = plist[i].bt;
+        m.weight[i] = cfs_weight(plist[i].pri);
+    }
+    cfs.data = &m;
+
+    sim_init(&sim, plist, n, &cfs, 1);
+    sim.timeline = tl;
+    sim_run(&sim);
+    for (i = 0; i < n; i++) {
+        plist[i].wt = sim.completion[i] - plist[i].art - plist[i].bt;
+        plist[i].rt = sim.first_run[i] == -1 ? 0 : sim.first_run[i] - plist[i].art;
+    }
+
+    sim_free(&sim);
+    free(m.tree.left);
+    free(m.tree.right);
+    free(m.tree.parent);
+    free(m.tree.red);
+    free(m.vruntime);
+    free(m.charged);
+    free(m.weight);
+    free(m.started);
+    return m.requeues;
+}
@@ -0,0 +1,45 @@
+#ifndef CFS_H
+#define CFS_H
+
+#include "process.h"
+#include "timeline.h"
+
+/**
+ * Completely Fair Scheduler on the event engine.
+ *
+ * Each process accumulates vruntime, its CPU time scaled by NICE_0_WEIGHT
+ * over its weight, and the CPU always goes to the ready process with the
+ * least. Weights come from the Linux nice-to-weight table with a nice of
+ * -pri, so a higher pri gets a larger share. Ready processes sit in a
+ * red-black tree ordered by vruntime, so picking the next one and putting
+ * one back each cost O(log n). A process runs for its weighted share of
+ * the target latency, stretched to the minimum granularity per process
+ * when too many are ready, and never for less than the granularity. New
+ * processes start at the smallest vruntime handed out so far and wait for
+ * the running slice to end.
+ */
+
+#define CFS_NICE_0_WEIGHT 1024
+#define CFS_VRUNTIME_SHIFT 20      // fixed point bits of vruntime
+
+typedef struct cfs_config {
+    int latency;       // time in which every ready process should run once
+    int granularity;   // shortest slice
+}CfsConfig;
+
+void cfs_default_config(CfsConfig *c);
+
+/* Applies a -LATENCY= or -GRANULARITY= option to c. Returns 1 when it took
+ * the option, 0 when it is not a CFS option and -1 when the value is
+ * invalid. */
+int cfs_parse_option(CfsConfig *c, char *arg);
+
+/* Weight of a process with priority pri. */
+int cfs_weight(int pri);
+
+/* Runs plist under CFS, filling in wt and rt, and records the runs on tl
+ * unless it is NULL. Returns the number of times a process was put back
+ * for another slice. */
+long long findWaitingTimeCFS(ProcessType plist[], int n, CfsConfig *c, TimelineType *tl);
+
+#endif				// CFS_H
@@ -0,0 +1,264 @@
+// Multi-level feedback queue policy for the event engine
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include "process.h"
+#include "sim.h"
+#include "mlfq.h"
+
+typedef struct mlfq {
+    MlfqConfig *cfg;
+    MlfqLevelType *stats;
+    ProcFifo queue[MLFQ_MAX_LEVELS];
+    int *level;
+    long long *used;       // time used at its level towards the allotment
+    int *stamp;            // boosts when used was last reset
+    long long *charged;    // rem when its CPU time was last counted
+    long long *since;      // when it got to its level
+    int boosts;
+}MlfqState;
+
+void mlfq_default_config(MlfqConfig *c)
+{
+    memset(c, 0, sizeof(MlfqConfig));
+    c->levels = 3;
+    c->quantum[0] = 2;
+    c->nquanta = 1;
+    c->boost = 100;
+    c->demote = MLFQ_DEMOTE_ALLOT;
+}
+
+// Reads a comma separated list of positive values into v, returns how many
+static int parse_list(char *s, int v[])
+{
+    int n = 0;
+    char *end;
+
+    for (;;) {
+        if (n == MLFQ_MAX_LEVELS) return -1;
+        v[n] = (int)strtol(s, &end, 10);
+        if (end == s || v[n] <= 0) return -1;
+        n++;
+        if (*end == '\0') return n;
+        if (*end != ',') return -1;
+        s = end + 1;
+    }
+}
+
+int mlfq_parse_option(MlfqConfig *c, char *arg)
+{
+    char *end;
+    int n;
+
+    if (strncmp(arg, "-LEVELS=", 8) == 0) {
+        c->levels = (int)strtol(arg + 8, &end, 10);
+        return *end == '\0' && c->levels >= 1 && c->levels <= MLFQ_MAX_LEVELS ? 1 : -1;
+    }
+    if (strncmp(arg, "-QUANTA=", 8) == 0) {
+        if ((n = parse_list(arg + 8, c->quantum)) < 0) return -1;
+        c->nquanta = n;
+        return 1;
+    }
+    if (strncmp(arg, "-ALLOT=", 7) == 0) {
+        if ((n = parse_list(arg + 7, c->allotment)) < 0) return -1;
+        c->nallotments = n;
+        return 1;
+    }
+    if (strncmp(arg, "-BOOST=", 7) == 0) {
+        c->boost = (int)strtol(arg + 7, &end, 10);
+        return *end == '\0' && c->boost >= 0 ? 1 : -1;
+    }
+    if (strcmp(arg, "-DEMOTE=ALLOT") == 0) {
+        c->demote = MLFQ_DEMOTE_ALLOT;
+        return 1;
+    }
+    if (strcmp(arg, "-DEMOTE=SLICE") == 0) {
+        c->demote = MLFQ_DEMOTE_SLICE;
+        return 1;
+    }
+    return strncmp(arg, "-DEMOTE=", 8) == 0 ? -1 : 0;
+}
+
+int mlfq_quantum(MlfqConfig *c, int level)
+{
+    if (level < c->nquanta) return c->quantum[level];
+    return 2 * mlfq_quantum(c, level - 1);
+}
+
+int mlfq_allotment(MlfqConfig *c, int level)
+{
+    if (level < c->nallotments) return c->allotment[level];
+    return mlfq_quantum(c, level);
+}
+
+// Time i used towards its allotment; a boost resets it for everyone
+static long long *usedOf(MlfqState *m, int i)
+{
+    if (m->stamp[i] != m->boosts) {
+        m->stamp[i] = m->boosts;
+        m->used[i] = 0;
+    }
+    return &m->used[i];
+}
+
+// Counts the CPU time i used since it was last counted, rem is what it has left now
+static long long charge(MlfqState *m, int i, long long rem)
+{
+    long long ran = m->charged[i] - rem;
+
+    m->stats[m->level[i]].run += ran;
+    *usedOf(m, i) += ran;
+    m->charged[i] = rem;
+    return ran;
+}
+
+static void move(MlfqState *m, int i, int level, long long now)
+{
+    m->stats[m->level[i]].residency += now - m->since[i];
+    m->level[i] = level;
+    m->since[i] = now;
+    m->stamp[i] = m->boosts;
+    m->used[i] = 0;
+}
+
+static void readyMlfq(SimType *s, int i)
+{
+    MlfqState *m = s->policy->data;
+    int level = m->level[i];
+    long long ran = charge(m, i, s->rem[i]);
+    int demote;
+
+    if (m->cfg->demote == MLFQ_DEMOTE_ALLOT)
+        demote = m->used[i] >= mlfq_allotment(m->cfg, level);
+    else {
+        demote = ran >= mlfq_quantum(m->cfg, level);
+        m->used[i] = 0;
+    }
+    if (demote && level < m->cfg->levels - 1) {
+        m->stats[level].demotions++;
+        move(m, i, level + 1, s->now);
+    }
+    proc_fifo_push(&m->queue[m->level[i]], i);
+}
+
+static int nextMlfq(SimType *s)
+{
+    MlfqState *m = s->policy->data;
+    int level, i, left;
+
+    for (level = 0; level < m->cfg->levels; level++)
+        if (m->queue[level].n > 0) break;
+    if (level == m->cfg->levels) return -1;
+
+    i = proc_fifo_pop(&m->queue[level]);
+    s->slice = mlfq_quantum(m->cfg, level);
+    left = mlfq_allotment(m->cfg, level) - *usedOf(m, i);
+    if (m->cfg->demote == MLFQ_DEMOTE_ALLOT && level < m->cfg->levels - 1 && left < s->slice)
+        s->slice = left;
+    return i;
+}
+
+static int preemptsMlfq(SimType *s, int i)
+{
+    MlfqState *m = s->policy->data;
+
+    return m->level[i] < m->level[s->running];
+}
+
+// Queued processes at a level other than 0
+static int queuedBelow(MlfqState *m)
+{
+    int level, n = 0;
+
+    for (level = 1; level < m->cfg->levels; level++)
+        n += m->queue[level].n;
+    return n;
+}
+
+// Moves every process back to level 0, until none are left to run. Only
+// those below level 0 move, each demoted since the last boost, so a boost
+// costs O(1) per demotion however many processes are queued. While the CPU
+// is idle with nothing queued the boosts up to the next arrival would move
+// nothing, so they are counted at once and the timer skips to the first
+// one at or after it
+static void boostMlfq(SimType *s)
+{
+    MlfqState *m = s->policy->data;
+    long long arrival, skipped;
+    int level, i;
+
+    if (m->queue[0].n == 0 && queuedBelow(m) == 0 && s->running == -1) {
+        if (s->admitted == s->n) return;
+        arrival = s->plist[s->order[s->admitted]].art;
+        skipped = arrival > s->now ? (arrival - s->now - 1) / m->cfg->boost : 0;
+        m->boosts += 1 + skipped;
+        event_push(&s->events, s->now + (skipped + 1) * m->cfg->boost, EVENT_TIMER, -1);
+        return;
+    }
+    m->boosts++;
+    for (level = 1; level < m->cfg->levels; level++) {
+        while ((i = proc_fifo_pop(&m->queue[level])) != -1) {
+            move(m, i, 0, s->now);
+            proc_fifo_push(&m->queue[0], i);
+        }
+    }
+    if (s->running != -1) {
+        charge(m, s->running, sim_running_rem(s));
+        move(m, s->running, 0, s->now);
+    }
+
+    event_push(&s->events, s->now + m->cfg->boost, EVENT_TIMER, -1);
+}
+
+int findWaitingTimeMLFQ(ProcessType plist[], int n, MlfqConfig *c, MlfqLevelType levels[], TimelineType *tl)
+{
+    SimPolicy mlfq = { readyMlfq, nextMlfq, 0, preemptsMlfq, boostMlfq };
+    MlfqState m;
+    SimType sim;
+    int i, level;
+
+    m.cfg = c;
+    m.stats = levels;
+    m.level = calloc(n + 1, sizeof(int));
+    m.used = calloc(n + 1, sizeof(long long));
+    m.stamp = calloc(n + 1, sizeof(int));
+    m.charged = malloc((n + 1) * sizeof(long long));
+    m.since = malloc((n + 1) * sizeof(long long));
+    m.boosts = 0;
+    memset(levels, 0, c->levels * sizeof(MlfqLevelType));
+    for (level = 0; level < c->levels; level++) {
+        m.queue[level].ring = malloc((n + 1) * sizeof(int));
+        m.queue[level].head = 0;
+        m.queue[level].n = 0;
+        m.queue[level].cap = n + 1;
+    }
+    for (i = 0; i < n; i++) {
+        m.charged[i] = plist[i].bt;
+        m.since[i] = plist[i].art;
+    }
+    mlfq.data = &m;
+
+    sim_init(&sim, plist, n, &mlfq, 1);
+    sim.timeline = tl;
+    if (c->boost > 0)
+        event_push(&sim.events, c->boost, EVENT_TIMER, -1);
+    sim_run(&sim);
+
+    for (i = 0; i < n; i++) {
+        charge(&m, i, 0);
+        move(&m, i, m.level[i], sim.completion[i]);
+        levels[m.level[i]].finished++;
+        plist[i].wt = sim.completion[i] - plist[i].art - plist[i].bt;
+        plist[i].rt = sim.first_run[i] == -1 ? 0 : sim.first_run[i] - plist[i].art;
+    }
+
+    sim_free(&sim);
+    for (level = 0; level < c->levels; level++)
+        free(m.queue[level].ring);
+    free(m.level);
+    free(m.used);
+    free(m.stamp);
+    free(m.charged);
+    free(m.since);
+    return m.boosts;
+}
@@ -0,0 +1,56 @@
+#ifndef MLFQ_H
+#define MLFQ_H
+
+#include "process.h"
+#include "timeline.h"
+
+/**
+ * Multi-level feedback queue scheduling on the event engine.
+ *
+ * Each level is a FIFO ring with its own quantum; the CPU goes to the head
+ * of the highest non-empty level, and a process arriving at level 0 takes
+ * it from one running lower down. A process moves down a level once it has
+ * used its allotment there (or, with MLFQ_DEMOTE_SLICE, after any run that
+ * uses a whole quantum), and every boost interval all processes go back to
+ * level 0 with their allotments reset.
+ */
+
+#define MLFQ_MAX_LEVELS 8
+
+#define MLFQ_DEMOTE_ALLOT 0    // time used at a level adds up across runs
+#define MLFQ_DEMOTE_SLICE 1    // only a run that uses the whole quantum counts
+
+typedef struct mlfq_config {
+    int levels;
+    int quantum[MLFQ_MAX_LEVELS];     // 0 for twice the level above
+    int allotment[MLFQ_MAX_LEVELS];   // 0 for the quantum of the level
+    int nquanta;                      // levels given a quantum
+    int nallotments;
+    int boost;                        // 0 for never
+    int demote;                       // MLFQ_DEMOTE_*
+}MlfqConfig;
+
+typedef struct mlfq_level {
+    long long residency;   // time processes spent at the level, ready or running
+    long long run;         // CPU time used at the level
+    int demotions;         // processes moved down to the next level
+    int finished;          // processes that completed at the level
+}MlfqLevelType;
+
+void mlfq_default_config(MlfqConfig *c);
+
+/* Applies a -LEVELS=, -QUANTA=, -ALLOT=, -BOOST= or -DEMOTE= option to c.
+ * Returns 1 when it took the option, 0 when it is not an MLFQ option and
+ * -1 when the value is invalid. */
+int mlfq_parse_option(MlfqConfig *c, char *arg);
+
+/* Quantum and allotment of a level once the defaults are filled in. */
+int mlfq_quantum(MlfqConfig *c, int level);
+int mlfq_allotment(MlfqConfig *c, int level);
+
+/* Runs plist through the queues, filling in wt and rt, and levels[] with
+ * the time spent at each of the c->levels levels, and records the runs on
+ * tl unless it is NULL. Returns the number of boosts. */
+int findWaitingTimeMLFQ(ProcessType plist[], int n, MlfqConfig *c, MlfqLevelType levels[], TimelineType *tl);
+
+#endif				// MLFQ_H
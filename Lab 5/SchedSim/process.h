@@ -8,8 +8,19 @@ typedef struct Process {
     int wt; // waiting time
     int tat; // turnaround time
     int pri; // priority
+    int rt; // response time
 }ProcessType; 
 
+/* A real-time task, one line of a task file. */
+typedef struct Task {
+    int pid; // Task ID
+    int wcet; // run time of each job
+    int phase; // release of the first job
+    int period; // between releases, the shortest one for a sporadic task
+    int deadline; // of each job after its release, 0 for the period
+    int jitter; // a sporadic release comes up to this much after the period
+}RtTaskType;
+
 typedef int (*Comparer) (const void *a, const void *b);
 
 #endif				// PROCESS_H
\ No newline at end of file
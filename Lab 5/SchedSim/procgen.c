@@ -0,0 +1,30 @@
+// Writes a synthetic process list in the schedsim input file format
+#include<stdio.h>
+#include<stdlib.h>
+
+#define MAX_BURST 20
+#define MAX_GAP 10         // between arrivals
+#define MAX_PRI 10
+
+int main(int argc, char *argv[])
+{
+    long long bytes, written = 0;
+    unsigned int seed = 1;
+    int pid = 0, art = 0, len;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: ./procgen <megabytes> [seed]\n");
+        return 1;
+    }
+    bytes = atoll(argv[1]) * 1024 * 1024;
+    if (argc > 2) seed = (unsigned int)atoi(argv[2]);
+
+    while (written < bytes) {
+        pid++;
+        art += rand_r(&seed) % (MAX_GAP + 1);
+        len = printf("%d %d %d 0 0 %d\n", pid, 1 + rand_r(&seed) % MAX_BURST, art, rand_r(&seed) % (MAX_PRI + 1));
+        if (len < 0) return 1;
+        written += len;
+    }
+    return 0;
+}
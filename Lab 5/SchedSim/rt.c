@@ -0,0 +1,256 @@
+// Earliest deadline first and rate monotonic policies for the event engine
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<math.h>
+#include "process.h"
+#include "sim.h"
+#include "rt.h"
+
+typedef struct rt {
+    long long *key;            // absolute deadline under EDF, period under RM
+}RtState;
+
+void rt_default_config(RtConfig *c)
+{
+    c->horizon = 0;
+}
+
+int rt_parse_option(RtConfig *c, char *arg)
+{
+    char *end;
+
+    if (strncmp(arg, "-HORIZON=", 9) == 0) {
+        c->horizon = (int)strtol(arg + 9, &end, 10);
+        return *end == '\0' && c->horizon > 0 ? 1 : -1;
+    }
+    return 0;
+}
+
+int rt_check_tasks(RtTaskType tasks[], int n)
+{
+    for (int i = 0; i < n; i++) {
+        if (tasks[i].period <= 0 || tasks[i].wcet < 0 || tasks[i].phase < 0 || tasks[i].deadline < 0
+            || tasks[i].jitter < 0)
+            return i;
+        if (tasks[i].deadline == 0) tasks[i].deadline = tasks[i].period;
+    }
+    return -1;
+}
+
+static long long gcd(long long a, long long b)
+{
+    while (b != 0) {
+        long long t = a % b;
+
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int rt_horizon(RtTaskType tasks[], int n, RtConfig *c)
+{
+    long long hyper = 1, phase = 0;
+
+    if (c->horizon > 0) return c->horizon;
+    for (int i = 0; i < n; i++) {
+        if (hyper <= RT_HORIZON_CAP)
+            hyper = hyper / gcd(hyper, tasks[i].period) * tasks[i].period;
+        if (tasks[i].phase > phase) phase = tasks[i].phase;
+    }
+    if (hyper > RT_HORIZON_CAP) hyper = RT_HORIZON_CAP;
+    return hyper + phase > INT_MAX ? INT_MAX : (int)(hyper + phase);
+}
+
+double rt_ll_bound(int n)
+{
+    return n > 0 ? n * (pow(2.0, 1.0 / n) - 1) : 1.0;
+}
+
+// Rate monotonic order: shorter period first, then file order
+static RtTaskType *rm_tasks;
+
+static int compareRate(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+
+    if (rm_tasks[x].period != rm_tasks[y].period) return rm_tasks[x].period < rm_tasks[y].period ? -1 : 1;
+    return x - y;
+}
+
+// Response time analysis: the worst response time of each task is the
+// fixed point of R = wcet + the wcet of every job of a higher priority
+// task released within R. Stops at the first task whose R passes the
+// shorter of its deadline and period, and fills in v for it
+static int responseTimes(RtTaskType tasks[], int n, RtVerdictType *v)
+{
+    int *order = malloc((n + 1) * sizeof(int));
+    long long r, next, limit;
+    int k, j, t;
+
+    for (k = 0; k < n; k++) order[k] = k;
+    rm_tasks = tasks;
+    qsort(order, n, sizeof(int), compareRate);
+
+    for (k = 0; k < n; k++) {
+        t = order[k];
+        limit = tasks[t].deadline < tasks[t].period ? tasks[t].deadline : tasks[t].period;
+        r = tasks[t].wcet;
+        for (;;) {
+            next = tasks[t].wcet;
+            for (j = 0; j < k && next <= limit; j++)
+                next += (r + tasks[order[j]].period - 1) / tasks[order[j]].period * tasks[order[j]].wcet;
+            if (next == r || next > limit) break;
+            r = next;
+        }
+        if (next > limit) {
+            v->task = t;
+            v->response = next;
+            free(order);
+            return 0;
+        }
+    }
+    free(order);
+    return 1;
+}
+
+void rt_schedulable(RtTaskType tasks[], int n, int policy, RtVerdictType *v)
+{
+    int implicit = 1, synchronous = 1;
+
+    v->utilization = v->density = 0;
+    v->bound = rt_ll_bound(n);
+    v->task = -1;
+    v->response = 0;
+    for (int i = 0; i < n; i++) {
+        v->utilization += (double)tasks[i].wcet / tasks[i].period;
+        v->density += (double)tasks[i].wcet / (tasks[i].deadline < tasks[i].period ? tasks[i].deadline : tasks[i].period);
+        if (tasks[i].deadline < tasks[i].period) implicit = 0;
+        if (tasks[i].phase != 0) synchronous = 0;
+    }
+
+    if (v->utilization > 1) {
+        v->result = RT_NOT_SCHEDULABLE;
+        v->test = "utilization over 1";
+    }
+    else if (policy == RT_EDF) {
+        v->result = implicit || v->density <= 1 ? RT_SCHEDULABLE : RT_UNKNOWN;
+        v->test = implicit ? "utilization at most 1" : v->density <= 1 ? "density at most 1" : "density over 1";
+    }
+    else if (implicit && v->utilization <= v->bound) {
+        v->result = RT_SCHEDULABLE;
+        v->test = "utilization within the Liu & Layland bound";
+    }
+    else if (responseTimes(tasks, n, v)) {
+        v->result = RT_SCHEDULABLE;
+        v->test = "response time analysis";
+    }
+    else {
+        // exact only when the tasks can all be released at once, and the
+        // next job of the task does not wait for the one that ran over
+        v->result = synchronous && tasks[v->task].deadline <= tasks[v->task].period
+                    ? RT_NOT_SCHEDULABLE : RT_UNKNOWN;
+        v->test = "response time analysis";
+    }
+}
+
+static void readyRt(SimType *s, int i)
+{
+    proc_heap_push(&s->heap, i);
+}
+
+static int nextRt(SimType *s)
+{
+    return proc_heap_pop(&s->heap);
+}
+
+static int preemptsRt(SimType *s, int i)
+{
+    RtState *m = s->policy->data;
+
+    return m->key[i] < m->key[s->running];
+}
+
+// Jobs of tasks released before horizon, at most
+static long long countJobs(RtTaskType tasks[], int n, int horizon)
+{
+    long long jobs = 0;
+
+    for (int i = 0; i < n; i++)
+        if (tasks[i].phase < horizon)
+            jobs += (horizon - 1 - tasks[i].phase) / tasks[i].period + 1;
+    return jobs;
+}
+
+ProcessType *findLatenessRT(RtTaskType tasks[], int n, int policy, int horizon, RtTaskStatsType per_task[],
+                            RtStatsType *stats, TimelineType *tl)
+{
+    SimPolicy rt = { readyRt, nextRt, 0, preemptsRt, NULL };
+    long long max = countJobs(tasks, n, horizon), release, lateness;
+    ProcessType *jobs;
+    RtState m;
+    SimType sim;
+    int *task, njobs = 0, i, t;
+    unsigned int seed;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->horizon = horizon;
+    stats->max_lateness = LLONG_MIN;
+    if (max > RT_MAX_JOBS) return NULL;
+    jobs = malloc((max + 1) * sizeof(ProcessType));
+    task = malloc((max + 1) * sizeof(int));
+    m.key = malloc((max + 1) * sizeof(long long));
+
+    // jobs task by task, so a tie on the key goes to the task first in the file
+    for (t = 0; t < n; t++) {
+        seed = t + 1;                // the same sporadic releases on every run
+        for (release = tasks[t].phase; release < horizon; njobs++) {
+            jobs[njobs].pid = tasks[t].pid;
+            jobs[njobs].bt = tasks[t].wcet;
+            jobs[njobs].art = (int)release;
+            jobs[njobs].pri = 0;
+            task[njobs] = t;
+            m.key[njobs] = policy == RT_EDF ? release + tasks[t].deadline : tasks[t].period;
+            release += tasks[t].period;
+            if (tasks[t].jitter > 0)
+                release += rand_r(&seed) % ((unsigned int)tasks[t].jitter + 1);
+        }
+    }
+    rt.data = &m;
+
+    sim_init(&sim, jobs, njobs, &rt, 1);
+    sim.heap.key = m.key;
+    sim.timeline = tl;
+    sim_run(&sim);
+
+    memset(per_task, 0, n * sizeof(RtTaskStatsType));
+    for (t = 0; t < n; t++)
+        per_task[t].max_lateness = LLONG_MIN;
+    for (i = 0; i < njobs; i++) {
+        RtTaskStatsType *p = &per_task[task[i]];
+
+        jobs[i].wt = sim.completion[i] - jobs[i].art - jobs[i].bt;
+        jobs[i].tat = sim.completion[i] - jobs[i].art;
+        jobs[i].rt = sim.first_run[i] == -1 ? 0 : sim.first_run[i] - jobs[i].art;
+        lateness = sim.completion[i] - (jobs[i].art + (long long)tasks[task[i]].deadline);
+        p->jobs++;
+        p->total_response += jobs[i].tat;
+        if (jobs[i].tat > p->max_response) p->max_response = jobs[i].tat;
+        if (lateness > p->max_lateness) p->max_lateness = lateness;
+        if (lateness > stats->max_lateness) stats->max_lateness = lateness;
+        if (lateness > 0) {
+            p->missed++;
+            stats->missed++;
+            stats->total_tardiness += lateness;
+        }
+    }
+    stats->jobs = njobs;
+    stats->preemptions = sim.preemptions;
+
+    sim_free(&sim);
+    free(task);
+    free(m.key);
+    return jobs;
+}
@@ -0,0 +1,97 @@
+#ifndef RT_H
+#define RT_H
+
+#include "process.h"
+#include "timeline.h"
+
+/**
+ * Real-time scheduling of periodic and sporadic tasks on the event engine.
+ *
+ * A task releases a job of wcet time units at its phase and then every
+ * period, a sporadic task each time up to jitter later than that, until
+ * the horizon, and each job is due deadline after its release. The jobs go
+ * through the engine as processes that arrive at their release. EDF gives
+ * the CPU to the ready job with the earliest absolute deadline and rate
+ * monotonic to the job of the task with the shortest period, both from a
+ * heap keyed on that, and a released job takes the CPU from a running one
+ * that comes after it. A job that misses its deadline still runs to
+ * completion.
+ *
+ * The schedulability checks assume the worst case of every task released
+ * at the same time and every sporadic job at its shortest period.
+ */
+
+#define RT_EDF 0
+#define RT_RM  1
+
+#define RT_HORIZON_CAP (1 << 20)   // default horizon when the hyperperiod is longer
+#define RT_MAX_JOBS (1 << 27)
+
+#define RT_SCHEDULABLE     1
+#define RT_NOT_SCHEDULABLE 0
+#define RT_UNKNOWN         -1
+
+typedef struct rt_config {
+    int horizon;       // last release time, 0 for the hyperperiod after the last phase
+}RtConfig;
+
+typedef struct rt_task_stats {
+    int jobs;
+    int missed;
+    long long max_lateness;    // largest completion - deadline of its jobs
+    long long max_response;
+    long long total_response;
+}RtTaskStatsType;
+
+typedef struct rt_stats {
+    int horizon;
+    int jobs;
+    int missed;
+    long long max_lateness;
+    long long total_tardiness; // lateness of the jobs that missed
+    long long preemptions;
+}RtStatsType;
+
+/* Outcome of a schedulability check, the test that decided it and, when
+ * response time analysis failed, the task that can miss. */
+typedef struct rt_verdict {
+    int result;                // RT_SCHEDULABLE, ...
+    char *test;
+    double utilization;        // sum of wcet / period
+    double density;            // sum of wcet / min(deadline, period)
+    double bound;              // Liu & Layland bound of rate monotonic
+    int task;                  // index, -1 for none
+    long long response;        // worst case response time of task
+}RtVerdictType;
+
+void rt_default_config(RtConfig *c);
+
+/* Applies a -HORIZON= option to c. Returns 1 when it took the option, 0
+ * when it is not a real-time option and -1 when the value is invalid. */
+int rt_parse_option(RtConfig *c, char *arg);
+
+/* Index of the first task that cannot run, with a period that is not
+ * positive or a negative field, -1 when they all can. Fills in the
+ * deadlines left at 0 with the period. */
+int rt_check_tasks(RtTaskType tasks[], int n);
+
+/* Horizon of a run of tasks under c. */
+int rt_horizon(RtTaskType tasks[], int n, RtConfig *c);
+
+/* Liu & Layland utilization bound n(2^(1/n) - 1) of rate monotonic. */
+double rt_ll_bound(int n);
+
+/* Checks whether tasks always meet their deadlines under policy: EDF by
+ * utilization, or density when a deadline is shorter than its period;
+ * rate monotonic by the Liu & Layland bound, then by response time
+ * analysis. */
+void rt_schedulable(RtTaskType tasks[], int n, int policy, RtVerdictType *v);
+
+/* Runs the jobs the tasks release until horizon under policy, filling in
+ * per_task and stats, and records the runs on tl unless it is NULL.
+ * Returns the jobs as processes with wt, tat and rt filled in, or NULL
+ * when horizon would release more than RT_MAX_JOBS. */
+ProcessType *findLatenessRT(RtTaskType tasks[], int n, int policy, int horizon, RtTaskStatsType per_task[],
+                            RtStatsType *stats, TimelineType *tl);
+
+#endif				// RT_H
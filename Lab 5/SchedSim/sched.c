@@ -0,0 +1,124 @@
+// Scheduling policies of the simulator
+#include<stdio.h>
+#include<stdlib.h>
+#include "process.h"
+#include "sim.h"
+#include "sched.h"
+#include "cfs.h"
+
+// Ready queue callbacks of the event engine for each policy
+static void readyFifo(SimType *s, int i) { proc_fifo_push(&s->fifo, i); }
+static int nextFifo(SimType *s) { return proc_fifo_pop(&s->fifo); }
+static void readyShortest(SimType *s, int i) { proc_heap_push(&s->heap, i); }
+static int nextShortest(SimType *s) { return proc_heap_pop(&s->heap); }
+static int preemptsShortest(SimType *s, int i) { return s->rem[i] < sim_running_rem(s); }
+
+// Calculate waiting time for Round Robin scheduling
+// Every process is ready at time 0 and they take turns in list order
+void findWaitingTimeRR(ProcessType plist[], int n, int quantum, TimelineType *tl) 
+{
+  SimPolicy rr = { readyFifo, nextFifo, quantum };
+  SimType sim;
+
+  sim_init(&sim, plist, n, &rr, 0);
+  sim.timeline = tl;
+  sim_run(&sim);
+  for(int i = 0; i < n; i++) {
+    plist[i].wt = sim.completion[i] - plist[i].bt;
+    plist[i].rt = sim.first_run[i] == -1 ? 0 : sim.first_run[i];
+  }
+  sim_free(&sim);
+} 
+
+// Calculate waiting time for Shortest Job First (SJF) scheduling
+// Every process is ready at time 0; ties go to the earlier one in the list
+void findWaitingTimeSJF(ProcessType plist[], int n, TimelineType *tl)
+{
+  SimPolicy sjf = { readyShortest, nextShortest, 0 };
+  SimType sim;
+
+  sim_init(&sim, plist, n, &sjf, 0);
+  sim.timeline = tl;
+  sim_run(&sim);
+  for(int i = 0; i < n; i++) {
+    plist[i].wt = sim.completion[i] - plist[i].art - plist[i].bt;
+    if(plist[i].wt < 0) plist[i].wt = 0;
+    plist[i].rt = plist[i].wt;
+  }
+  sim_free(&sim);
+} 
+
+// Calculate waiting time for Shortest Remaining Time First (SRTF) scheduling
+// Processes arrive at art; one that arrives with less left than the running
+// one takes the CPU from it, ties stay with the running process
+void findWaitingTimeSRTF(ProcessType plist[], int n, TimelineType *tl)
+{
+  SimPolicy srtf = { readyShortest, nextShortest, 0, preemptsShortest };
+  SimType sim;
+
+  sim_init(&sim, plist, n, &srtf, 1);
+  sim.timeline = tl;
+  sim_run(&sim);
+  for(int i = 0; i < n; i++) {
+    plist[i].wt = sim.completion[i] - plist[i].art - plist[i].bt;
+    plist[i].rt = sim.first_run[i] == -1 ? 0 : sim.first_run[i] - plist[i].art;
+  }
+  sim_free(&sim);
+}
+
+// Calculate waiting time for First Come First Serve (FCFS)
+void findWaitingTime(ProcessType plist[], int n)
+{ 
+    plist[0].wt = plist[0].art;
+    for (int i = 1; i < n; i++) 
+        plist[i].wt = plist[i-1].bt + plist[i-1].wt; 
+    for (int i = 0; i < n; i++) 
+        plist[i].rt = plist[i].wt; 
+} 
+  
+// Calculate turnaround time
+void findTurnAroundTime(ProcessType plist[], int n)
+{ 
+    for (int i = 0; i < n; i++) 
+        plist[i].tat = plist[i].bt + plist[i].wt; 
+} 
+
+// Comparison function for priority scheduling
+int my_comparer(const void *this, const void *that)
+{ 
+    ProcessType *process1 = (ProcessType *)this;
+    ProcessType *process2 = (ProcessType *)that;
+    if (process1->pri > process2->pri) return -1;
+    if (process1->pri < process2->pri) return 1;
+    return 0;
+}
+
+// Calculate waiting time for Priority scheduling
+// Sorts plist by priority, highest first, and runs it in that order
+void findWaitingTimePriority(ProcessType plist[], int n)
+{
+  qsort(plist, n, sizeof(ProcessType), my_comparer);
+  plist[0].wt = plist[0].art;
+  for (int i = 1; i < n; i++) {
+    plist[i].wt = plist[i-1].bt + plist[i-1].wt;
+    if (plist[i].art > plist[i].wt) plist[i].wt = plist[i].art;
+  }
+  for (int i = 0; i < n; i++)
+    plist[i].rt = plist[i].wt;
+}
+
+// Jain's fairness index of the rates bt / tat at which the processes got
+// service, each divided by its CFS weight when weighted is set. 1 when every
+// process got the same, 1/n when one got it all
+double jainIndex(ProcessType plist[], int n, int weighted)
+{
+  double x, sum = 0, squares = 0;
+
+  for (int i = 0; i < n; i++) {
+    x = plist[i].tat > 0 ? (double)plist[i].bt / plist[i].tat : 1.0;
+    if (weighted) x = x * CFS_NICE_0_WEIGHT / cfs_weight(plist[i].pri);
+    sum += x;
+    squares += x * x;
+  }
+  return squares > 0 ? sum * sum / (n * squares) : 1.0;
+}
@@ -0,0 +1,27 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "process.h"
+#include "timeline.h"
+
+/**
+ * Scheduling policies. Each findWaitingTime function fills in the waiting
+ * and response time of every process of plist; findTurnAroundTime adds the
+ * turnaround times from those. Those on the event engine record their runs
+ * on tl unless it is NULL.
+ */
+
+void findWaitingTime(ProcessType plist[], int n);                  // FCFS
+void findWaitingTimeSJF(ProcessType plist[], int n, TimelineType *tl);
+void findWaitingTimeSRTF(ProcessType plist[], int n, TimelineType *tl);
+void findWaitingTimeRR(ProcessType plist[], int n, int quantum, TimelineType *tl);
+void findWaitingTimePriority(ProcessType plist[], int n);          // reorders plist
+void findTurnAroundTime(ProcessType plist[], int n);
+
+int my_comparer(const void *this, const void *that);
+
+/* Jain's fairness index of the service rates bt / tat, divided by the CFS
+ * weight of each process when weighted is set. Needs wt and tat filled in. */
+double jainIndex(ProcessType plist[], int n, int weighted);
+
+#endif				// SCHED_H
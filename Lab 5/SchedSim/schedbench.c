@@ -0,0 +1,438 @@
+// Benchmarks of the scheduling policies
+//
+// Random process lists of growing size go through two SRTF simulations: the
+// per time unit scan the simulator used to run SJF with, extended to respect
+// arrival times, and the event engine with a heap ready queue. Both pick the
+// shortest remaining time, lowest index among equals, and only take the CPU
+// from the running process for a strictly shorter one, so their waiting
+// times must agree. The scan is stopped after SCAN_BUDGET_NS and its runtime
+// extrapolated from the time units it got through.
+//
+// A second run puts lists that all arrive at once through CFS, RR and
+// Priority, for their runtime and how fairly each shares the CPU by Jain's
+// index, plain and weighted by the CFS weight of each process's priority.
+//
+// A third times the FCFS waiting time, turnaround and average passes over
+// TABLE_PROCS processes kept as ProcessType structs, and as ProcTable
+// columns run through plain loops and through its kernels.
+//
+// A fourth runs random periodic task sets of growing size that ask for
+// RT_LOAD_PERCENT of the CPU through EDF and rate monotonic, over a horizon
+// that releases about RT_JOBS jobs, against the schedulability checks.
+//
+// Given a process list file (see procgen) it instead times parsing it, with
+// the two pass fscanf parser the simulator used to have and with parse_file.
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<time.h>
+#include<math.h>
+#include<sys/stat.h>
+#include "process.h"
+#include "util.h"
+#include "sim.h"
+#include "sched.h"
+#include "cfs.h"
+#include "table.h"
+#include "rt.h"
+
+#define MAX_BURST 20
+#define LOAD_PERCENT 90            // of the CPU the arrivals ask for
+#define SCAN_BUDGET_NS 5000000000LL
+#define MAX_PRI 10
+#define RR_QUANTUM 2
+#define TABLE_PROCS 10000000
+#define TABLE_REPEATS 5            // best of
+#define RT_LOAD_PERCENT 90
+#define RT_JOBS 1000000
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Random processes with arrivals spread so they ask for LOAD_PERCENT of the CPU
+static ProcessType *randomProc(int n, unsigned int *seed)
+{
+    ProcessType *plist = calloc(n, sizeof(ProcessType));
+    long long span = (long long)n * (MAX_BURST + 1) / 2 * 100 / LOAD_PERCENT;
+
+    for (int i = 0; i < n; i++) {
+        plist[i].pid = i + 1;
+        plist[i].bt = 1 + rand_r(seed) % MAX_BURST;
+        plist[i].art = (int)(((long long)rand_r(seed) * RAND_MAX + rand_r(seed)) % span);
+    }
+    return plist;
+}
+
+// SRTF by scanning every process each time unit; returns the time units
+// simulated, fewer than the schedule takes if it ran out of budget
+static long long scanSRTF(ProcessType plist[], int n, long long *completion)
+{
+    int *rem_bt = malloc(n * sizeof(int));
+    int complete = 0, running = -1;
+    long long current_time = 0, start_ns = now_ns();
+
+    for (int i = 0; i < n; i++) rem_bt[i] = plist[i].bt;
+    while (complete != n) {
+        if ((current_time & 1023) == 0 && now_ns() - start_ns > SCAN_BUDGET_NS) break;
+        int min_bt = running == -1 ? INT_MAX : rem_bt[running], shortest = running;
+        for (int i = 0; i < n; i++) {
+            if (rem_bt[i] > 0 && plist[i].art <= current_time && rem_bt[i] < min_bt) {
+                min_bt = rem_bt[i];
+                shortest = i;
+            }
+        }
+        running = shortest;
+        current_time++;
+        if (running == -1) continue;
+        if (--rem_bt[running] == 0) {
+            complete++;
+            completion[running] = current_time;
+            running = -1;
+        }
+    }
+    free(rem_bt);
+    return current_time;
+}
+
+// Processes of random priority and the same burst that all arrive at time
+// 0, so a fair share shows as finishing close together
+static ProcessType *batchProc(int n, unsigned int *seed)
+{
+    ProcessType *plist = calloc(n, sizeof(ProcessType));
+
+    for (int i = 0; i < n; i++) {
+        plist[i].pid = i + 1;
+        plist[i].bt = MAX_BURST;
+        plist[i].pri = rand_r(seed) % (MAX_PRI + 1);
+    }
+    return plist;
+}
+
+static void benchFairness(void)
+{
+    int sizes[] = { 1000, 10000, 100000, 1000000 };
+    char *names[] = { "CFS", "RR", "Priority" };
+    CfsConfig cfs;
+    unsigned int seed = 7;
+
+    cfs_default_config(&cfs);
+    printf("\n%8s %10s %12s %12s %8s %9s\n", "procs", "policy", "ms", "procs/s", "jain", "weighted");
+    for (int k = 0; k < (int)(sizeof(sizes) / sizeof(sizes[0])); k++) {
+        int n = sizes[k];
+        ProcessType *batch = batchProc(n, &seed);
+        ProcessType *plist = malloc(n * sizeof(ProcessType));
+
+        for (int p = 0; p < 3; p++) {
+            long long start_ns, run_ns;
+
+            memcpy(plist, batch, n * sizeof(ProcessType));
+            start_ns = now_ns();
+            if (p == 0) findWaitingTimeCFS(plist, n, &cfs, NULL);
+            else if (p == 1) findWaitingTimeRR(plist, n, RR_QUANTUM, NULL);
+            else findWaitingTimePriority(plist, n);
+            findTurnAroundTime(plist, n);
+            run_ns = now_ns() - start_ns;
+            printf("%8d %10s %12.2f %12.0f %8.4f %9.4f\n", n, names[p], run_ns / 1e6,
+                   run_ns > 0 ? n / (run_ns / 1e9) : 0.0, jainIndex(plist, n, 0), jainIndex(plist, n, 1));
+        }
+        free(plist);
+        free(batch);
+    }
+}
+
+// Results of one layout, to check they all agree
+typedef struct table_result {
+    long long wt;
+    long long tat;
+    long long rt;
+    int max_wt;
+    long long ns[3];           // waiting time, turnaround and sums passes
+}TableResult;
+
+static void keepBest(TableResult *best, long long ns[3])
+{
+    for (int k = 0; k < 3; k++)
+        if (best->ns[k] == 0 || ns[k] < best->ns[k]) best->ns[k] = ns[k];
+}
+
+static void tableStructs(ProcessType plist[], int n, TableResult *r)
+{
+    long long start_ns = now_ns(), ns[3];
+
+    findWaitingTime(plist, n);
+    for (int i = 0; i < n; i++) plist[i].rt = plist[i].wt;
+    ns[0] = now_ns() - start_ns;
+    start_ns = now_ns();
+    findTurnAroundTime(plist, n);
+    ns[1] = now_ns() - start_ns;
+    start_ns = now_ns();
+    r->wt = r->tat = r->rt = 0;
+    r->max_wt = 0;
+    for (int i = 0; i < n; i++) {
+        r->wt += plist[i].wt;
+        r->tat += plist[i].tat;
+        r->rt += plist[i].rt;
+        if (plist[i].wt > r->max_wt) r->max_wt = plist[i].wt;
+    }
+    ns[2] = now_ns() - start_ns;
+    keepBest(r, ns);
+}
+
+static void tableLoops(ProcTable *t, TableResult *r)
+{
+    long long start_ns = now_ns(), ns[3];
+    int n = t->n;
+
+    t->wt[0] = t->art[0];
+    for (int i = 1; i < n; i++) t->wt[i] = t->wt[i - 1] + t->bt[i - 1];
+    for (int i = 0; i < n; i++) t->rt[i] = t->wt[i];
+    ns[0] = now_ns() - start_ns;
+    start_ns = now_ns();
+    for (int i = 0; i < n; i++) t->tat[i] = t->bt[i] + t->wt[i];
+    ns[1] = now_ns() - start_ns;
+    start_ns = now_ns();
+    r->wt = r->tat = r->rt = 0;
+    r->max_wt = 0;
+    for (int i = 0; i < n; i++) r->wt += t->wt[i];
+    for (int i = 0; i < n; i++) r->tat += t->tat[i];
+    for (int i = 0; i < n; i++) r->rt += t->rt[i];
+    for (int i = 0; i < n; i++) if (t->wt[i] > r->max_wt) r->max_wt = t->wt[i];
+    ns[2] = now_ns() - start_ns;
+    keepBest(r, ns);
+}
+
+static void tableKernels(ProcTable *t, TableResult *r)
+{
+    long long start_ns = now_ns(), ns[3];
+
+    table_fcfs_wait(t);
+    ns[0] = now_ns() - start_ns;
+    start_ns = now_ns();
+    table_turnaround(t);
+    ns[1] = now_ns() - start_ns;
+    start_ns = now_ns();
+    r->wt = table_sum(t->wt, t->n);
+    r->tat = table_sum(t->tat, t->n);
+    r->rt = table_sum(t->rt, t->n);
+    r->max_wt = table_max(t->wt, t->n);
+    ns[2] = now_ns() - start_ns;
+    keepBest(r, ns);
+}
+
+static void benchTable(void)
+{
+    char *names[] = { "structs", "columns", "kernels" };
+    TableResult r[3];
+    ProcTable t;
+    unsigned int seed = 11;
+    int n = TABLE_PROCS;
+    ProcessType *plist = calloc(n, sizeof(ProcessType));
+
+    for (int i = 0; i < n; i++) {
+        plist[i].pid = i + 1;
+        plist[i].bt = 1 + rand_r(&seed) % MAX_BURST;
+        plist[i].art = rand_r(&seed) % MAX_BURST;
+    }
+    table_init(&t, n);
+    table_load(&t, plist, n);
+    memset(r, 0, sizeof(r));
+    for (int rep = 0; rep < TABLE_REPEATS; rep++) {
+        tableStructs(plist, n, &r[0]);
+        tableLoops(&t, &r[1]);
+        tableKernels(&t, &r[2]);
+    }
+
+    printf("\n%8s %10s %12s %12s %12s %12s %8s\n", "procs", "layout", "wait ms", "tat ms", "sums ms",
+           "total ms", "same");
+    for (int k = 0; k < 3; k++)
+        printf("%8d %10s %12.2f %12.2f %12.2f %12.2f %8s\n", n, names[k], r[k].ns[0] / 1e6, r[k].ns[1] / 1e6,
+               r[k].ns[2] / 1e6, (r[k].ns[0] + r[k].ns[1] + r[k].ns[2]) / 1e6,
+               r[k].wt == r[0].wt && r[k].tat == r[0].tat && r[k].rt == r[0].rt && r[k].max_wt == r[0].max_wt
+               ? "yes" : "NO");
+    table_free(&t);
+    free(plist);
+}
+
+// n synchronous tasks with utilizations drawn by UUniFast to add up to
+// RT_LOAD_PERCENT, and periods between 10n and 100n so every wcet comes
+// out at a few dozen time units whatever n is
+static RtTaskType *randomTasks(int n, unsigned int *seed)
+{
+    RtTaskType *tasks = malloc(n * sizeof(RtTaskType));
+    double left = RT_LOAD_PERCENT / 100.0, next, u;
+
+    for (int i = 0; i < n; i++) {
+        next = i == n - 1 ? 0 : left * pow((double)rand_r(seed) / RAND_MAX, 1.0 / (n - 1 - i));
+        u = left - next;
+        left = next;
+        tasks[i].pid = i + 1;
+        tasks[i].period = 10 * n + rand_r(seed) % (90 * n + 1);
+        tasks[i].wcet = (int)(u * tasks[i].period + 0.5);
+        if (tasks[i].wcet < 1) tasks[i].wcet = 1;
+        tasks[i].phase = 0;
+        tasks[i].deadline = tasks[i].period;
+        tasks[i].jitter = 0;
+    }
+    return tasks;
+}
+
+static void benchRealTime(void)
+{
+    int sizes[] = { 10, 100, 1000, 10000 };
+    char *results[] = { "unknown", "no", "yes" };
+    RtVerdictType v;
+    RtStatsType stats;
+    unsigned int seed = 11;
+
+    printf("\n%8s %8s %10s %10s %12s %8s %9s %10s %9s %9s\n", "tasks", "policy", "jobs", "ms", "jobs/s",
+           "util", "missed", "lateness", "check ms", "verdict");
+    for (int k = 0; k < (int)(sizeof(sizes) / sizeof(sizes[0])); k++) {
+        int n = sizes[k], horizon;
+        RtTaskType *tasks = randomTasks(n, &seed);
+        RtTaskStatsType *per_task = malloc(n * sizeof(RtTaskStatsType));
+        double rate = 0;
+
+        for (int i = 0; i < n; i++) rate += 1.0 / tasks[i].period;
+        horizon = (int)(RT_JOBS / rate);
+        for (int policy = RT_EDF; policy <= RT_RM; policy++) {
+            long long start_ns, run_ns, check_ns;
+            ProcessType *jobs;
+
+            start_ns = now_ns();
+            jobs = findLatenessRT(tasks, n, policy, horizon, per_task, &stats, NULL);
+            run_ns = now_ns() - start_ns;
+            start_ns = now_ns();
+            rt_schedulable(tasks, n, policy, &v);
+            check_ns = now_ns() - start_ns;
+            printf("%8d %8s %10d %10.2f %12.0f %8.4f %8.3f%% %10lld %9.2f %9s\n", n,
+                   policy == RT_EDF ? "EDF" : "RM", stats.jobs, run_ns / 1e6,
+                   run_ns > 0 ? stats.jobs / (run_ns / 1e9) : 0.0, v.utilization,
+                   stats.jobs > 0 ? 100.0 * stats.missed / stats.jobs : 0.0, stats.max_lateness,
+                   check_ns / 1e6, results[v.result + 1]);
+            free(jobs);
+        }
+        free(per_task);
+        free(tasks);
+    }
+}
+
+// The parser parse_file replaced: counts the processes with fscanf, then
+// rewinds and reads them all again
+static ProcessType *scanfParse(FILE *f, int *P_SIZE)
+{
+    int i = 0;
+    ProcessType *pptr = (ProcessType *) malloc(sizeof(ProcessType));
+
+    while (!feof(f)) {
+        if (fscanf(f, "%d %d %d %d %d %d\n", &(pptr->pid), &(pptr->bt), &(pptr->art), &(pptr->wt), &(pptr->tat), &(pptr->pri)) < 0) break;
+        *P_SIZE += 1;
+    }
+    free(pptr);
+    fseek(f, 0, SEEK_SET);
+
+    pptr = (ProcessType *) calloc(*P_SIZE, sizeof(ProcessType));
+    while (!feof(f) && i < *P_SIZE) {
+        if (fscanf(f, "%d %d %d %d %d %d\n", &(pptr[i].pid), &(pptr[i].bt), &(pptr[i].art), &(pptr[i].wt), &(pptr[i].tat), &(pptr[i].pri)) < 0) break;
+        i++;
+    }
+    return pptr;
+}
+
+// Hash of the fields read from the file, to compare parsers without keeping both lists
+static unsigned long long checksum(ProcessType plist[], int n)
+{
+    unsigned long long h = 14695981039346656037ULL;
+
+    for (int i = 0; i < n; i++) {
+        int v[6] = { plist[i].pid, plist[i].bt, plist[i].art, plist[i].wt, plist[i].tat, plist[i].pri };
+        for (int k = 0; k < 6; k++)
+            h = (h ^ (unsigned int)v[k]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static void benchParse(char *filename)
+{
+    ProcessType *(*parsers[])(FILE *, int *) = { scanfParse, parse_file };
+    char *names[] = { "fscanf x2", "parse_file" };
+    unsigned long long sum[2];
+    int n[2] = { 0, 0 };
+    struct stat st;
+
+    if (stat(filename, &st) != 0) {
+        fprintf(stderr, "Error: Invalid filepath\n");
+        exit(1);
+    }
+    printf("%s: %.1f MB\n", filename, st.st_size / 1048576.0);
+    printf("%12s %12s %10s %10s\n", "parser", "processes", "ms", "MB/s");
+    for (int p = 0; p < 2; p++) {
+        FILE *f = fopen(filename, "r");
+        long long start_ns = now_ns(), run_ns;
+
+        ProcessType *plist = parsers[p](f, &n[p]);
+        run_ns = now_ns() - start_ns;
+        fclose(f);
+        printf("%12s %12d %10.0f %10.1f\n", names[p], n[p], run_ns / 1e6, st.st_size / 1048576.0 / (run_ns / 1e9));
+        sum[p] = checksum(plist, n[p]);
+        free(plist);
+    }
+    printf("same: %s\n", n[0] == n[1] && sum[0] == sum[1] ? "yes" : "NO");
+}
+
+static void readyShortest(SimType *s, int i) { proc_heap_push(&s->heap, i); }
+static int nextShortest(SimType *s) { return proc_heap_pop(&s->heap); }
+static int preemptsShortest(SimType *s, int i) { return s->rem[i] < sim_running_rem(s); }
+
+int main(int argc, char *argv[])
+{
+    int sizes[] = { 1000, 10000, 100000 };
+    SimPolicy srtf = { readyShortest, nextShortest, 0, preemptsShortest };
+    unsigned int seed = 42;
+
+    if (argc > 1) {
+        benchParse(argv[1]);
+        return 0;
+    }
+    printf("%8s %14s %14s %10s %10s %8s\n", "procs", "scan ms", "heap ms", "speedup", "preempts", "same");
+    for (int k = 0; k < (int)(sizeof(sizes) / sizeof(sizes[0])); k++) {
+        int n = sizes[k], same = 1;
+        ProcessType *plist = randomProc(n, &seed);
+        long long *completion = calloc(n, sizeof(long long));
+        long long start_ns, scan_ns, heap_ns, ticks;
+        SimType sim;
+
+        start_ns = now_ns();
+        sim_init(&sim, plist, n, &srtf, 1);
+        sim_run(&sim);
+        heap_ns = now_ns() - start_ns;
+
+        start_ns = now_ns();
+        ticks = scanSRTF(plist, n, completion);
+        scan_ns = now_ns() - start_ns;
+        if (ticks < sim.now) {
+            scan_ns = (long long)((double)scan_ns * sim.now / ticks);
+            same = -1;                   // only the time units it got through
+        }
+        for (int i = 0; i < n && same == 1; i++)
+            same = completion[i] == sim.completion[i];
+
+        printf("%8d %13.1f%s %14.2f %9.0fx %10lld %8s\n", n, scan_ns / 1e6, same == -1 ? "*" : " ",
+               heap_ns / 1e6, (double)scan_ns / heap_ns, sim.preemptions,
+               same == -1 ? "-" : same ? "yes" : "NO");
+        sim_free(&sim);
+        free(completion);
+        free(plist);
+    }
+    printf("* scan stopped after %lld s, time extrapolated\n", SCAN_BUDGET_NS / 1000000000LL);
+
+    benchFairness();
+    benchTable();
+    benchRealTime();
+    return 0;
+}
@@ -2,92 +2,18 @@
 #include<stdio.h> 
 #include<limits.h>
 #include<stdlib.h>
+#include<string.h>
 #include "process.h"
 #include "util.h"
-
-// Calculate waiting time for Round Robin scheduling
-void findWaitingTimeRR(ProcessType plist[], int n, int quantum) 
-{
-  int *rem_bt = (int*)malloc(n * sizeof(int));  // Track remaining burst times
-  for(int i = 0; i < n; i++) rem_bt[i] = plist[i].bt;
-  for(int i = 0; i < n; i++) plist[i].wt = 0;  // Initialize waiting times
-  int t = 0;
-  int done;
-  do {
-    done = 1;
-    for(int i = 0; i < n; i++) {
-      if(rem_bt[i] > 0) {
-        done = 0;
-        if(rem_bt[i] > quantum) {
-          t += quantum;
-          rem_bt[i] -= quantum;
-        } else {
-          t += rem_bt[i];
-          plist[i].wt = t - plist[i].bt;
-          rem_bt[i] = 0;
-        }
-      }
-    }
-  } while(!done); 
-  free(rem_bt);
-} 
-
-// Calculate waiting time for Shortest Job First (SJF) scheduling
-void findWaitingTimeSJF(ProcessType plist[], int n)
-{
-  int *rem_bt = (int*)malloc(n * sizeof(int));
-  int *completion_time = (int*)malloc(n * sizeof(int));
-  int complete = 0, current_time = 0;
-  for(int i = 0; i < n; i++) rem_bt[i] = plist[i].bt;
-  while(complete != n) {
-    int min_bt = INT_MAX, shortest = -1;
-    for(int i = 0; i < n; i++) {
-      if(rem_bt[i] > 0 && rem_bt[i] < min_bt) {
-        min_bt = rem_bt[i];
-        shortest = i;
-      }
-    }
-    if(shortest == -1) {
-      current_time++;
-      continue;
-    }
-    rem_bt[shortest]--;
-    if(rem_bt[shortest] == 0) {
-      complete++;
-      completion_time[shortest] = current_time + 1;
-      plist[shortest].wt = completion_time[shortest] - plist[shortest].art - plist[shortest].bt;
-      if(plist[shortest].wt < 0) plist[shortest].wt = 0;
-    }
-    current_time++;
-  }
-  free(rem_bt);
-  free(completion_time);
-} 
-
-// Calculate waiting time for First Come First Serve (FCFS)
-void findWaitingTime(ProcessType plist[], int n)
-{ 
-    plist[0].wt = plist[0].art;
-    for (int i = 1; i < n; i++) 
-        plist[i].wt = plist[i-1].bt + plist[i-1].wt; 
-} 
-  
-// Calculate turnaround time
-void findTurnAroundTime(ProcessType plist[], int n)
-{ 
-    for (int i = 0; i < n; i++) 
-        plist[i].tat = plist[i].bt + plist[i].wt; 
-} 
-
-// Comparison function for priority scheduling
-int my_comparer(const void *this, const void *that)
-{ 
-    ProcessType *process1 = (ProcessType *)this;
-    ProcessType *process2 = (ProcessType *)that;
-    if (process1->pri > process2->pri) return -1;
-    if (process1->pri < process2->pri) return 1;
-    return 0;
-} 
+#include "sim.h"
+#include "sched.h"
+#include "mlfq.h"
+#include "smp.h"
+#include "cfs.h"
+#include "rt.h"
+#include "table.h"
+#include "timeline.h"
+#include "sweep.h"
 
 // Calculate average time for FCFS scheduling
 void findavgTimeFCFS(ProcessType plist[], int n) 
@@ -98,17 +24,64 @@ void findavgTimeFCFS(ProcessType plist[], int n)
 }
 
 // Calculate average time for SJF scheduling
-void findavgTimeSJF(ProcessType plist[], int n) 
+void findavgTimeSJF(ProcessType plist[], int n, TimelineType *tl) 
 { 
-    findWaitingTimeSJF(plist, n); 
+    findWaitingTimeSJF(plist, n, tl); 
     findTurnAroundTime(plist, n); 
     printf("\n*********\nSJF\n");
 }
 
+// Calculate average time for SRTF scheduling
+void findavgTimeSRTF(ProcessType plist[], int n, TimelineType *tl) 
+{ 
+    findWaitingTimeSRTF(plist, n, tl); 
+    findTurnAroundTime(plist, n); 
+    printf("\n*********\nSRTF\n");
+}
+
+// Calculate average time for MLFQ scheduling
+int findavgTimeMLFQ(ProcessType plist[], int n, MlfqConfig *c, MlfqLevelType levels[], TimelineType *tl) 
+{ 
+    int boosts = findWaitingTimeMLFQ(plist, n, c, levels, tl); 
+    findTurnAroundTime(plist, n); 
+    printf("\n*********\nMLFQ Levels = %d Boost = %d Demote = %s\n", c->levels, c->boost,
+           c->demote == MLFQ_DEMOTE_ALLOT ? "ALLOT" : "SLICE");
+    return boosts;
+}
+
+// Calculate average time for SMP scheduling
+void findavgTimeSMP(ProcessType plist[], int n, int ncores, int quantum, SmpConfig *c,
+                    SmpCoreType cores[], SmpStatsType *stats, TimelineType *tl) 
+{ 
+    findWaitingTimeSMP(plist, n, ncores, quantum, c, cores, stats, tl); 
+    findTurnAroundTime(plist, n); 
+    printf("\n*********\nSMP Cores = %d Quantum = %d Steal = %s Balance = %d Migration = %d\n",
+           ncores, quantum, c->steal ? "on" : "off", c->balance, c->migration);
+}
+
+// Calculate average time for CFS scheduling
+long long findavgTimeCFS(ProcessType plist[], int n, CfsConfig *c, TimelineType *tl) 
+{ 
+    long long requeues = findWaitingTimeCFS(plist, n, c, tl); 
+    findTurnAroundTime(plist, n); 
+    printf("\n*********\nCFS Latency = %d Granularity = %d\n", c->latency, c->granularity);
+    return requeues;
+}
+
+// Calculate lateness of the jobs of real-time tasks under EDF or RM
+ProcessType *findavgTimeRT(RtTaskType tasks[], int n, int policy, int horizon, RtTaskStatsType per_task[],
+                           RtStatsType *stats, TimelineType *tl) 
+{ 
+    ProcessType *jobs = findLatenessRT(tasks, n, policy, horizon, per_task, stats, tl); 
+    if (jobs != NULL)
+        printf("\n*********\n%s Horizon = %d\n", policy == RT_EDF ? "EDF" : "RM", horizon);
+    return jobs;
+}
+
 // Calculate average time for Round Robin scheduling
-void findavgTimeRR(ProcessType plist[], int n, int quantum) 
+void findavgTimeRR(ProcessType plist[], int n, int quantum, TimelineType *tl) 
 { 
-    findWaitingTimeRR(plist, n, quantum); 
+    findWaitingTimeRR(plist, n, quantum, tl); 
     findTurnAroundTime(plist, n); 
     printf("\n*********\nRR Quantum = %d\n", quantum);
 }
@@ -116,12 +89,7 @@ void findavgTimeRR(ProcessType plist[], int n, int quantum)
 // Calculate average time for Priority scheduling
 void findavgTimePriority(ProcessType plist[], int n) 
 { 
-  qsort(plist, n, sizeof(ProcessType), my_comparer);
-  plist[0].wt = plist[0].art;
-  for (int i = 1; i < n; i++) {
-    plist[i].wt = plist[i-1].bt + plist[i-1].wt;
-    if (plist[i].art > plist[i].wt) plist[i].wt = plist[i].art;
-  }
+  findWaitingTimePriority(plist, n);
   findTurnAroundTime(plist, n);
   printf("\n*********\nPriority\n");
 }
@@ -129,7 +97,7 @@ void findavgTimePriority(ProcessType plist[], int n)
 // Print metrics for each process
 void printMetrics(ProcessType plist[], int n)
 {
-    int total_wt = 0, total_tat = 0; 
+    long long total_wt = 0, total_tat = 0;   // a million processes overflow an int
     float awt, att;
     
     printf("\tProcesses\tBurst time\tWaiting time\tTurn around time\n"); 
@@ -146,6 +114,159 @@ void printMetrics(ProcessType plist[], int n)
     printf("\nAverage turn around time = %.2f\n", att); 
 } 
 
+// Print response times and where MLFQ kept the processes
+void printLevels(ProcessType plist[], int n, MlfqConfig *c, MlfqLevelType levels[], int boosts)
+{
+    long long total_rt = 0, total_residency = 0;
+    int max_rt = 0;
+
+    for (int i = 0; i < n; i++) {
+        total_rt += plist[i].rt;
+        if (plist[i].rt > max_rt) max_rt = plist[i].rt;
+    }
+    for (int k = 0; k < c->levels; k++)
+        total_residency += levels[k].residency;
+
+    printf("Average response time = %.2f\n", (float)total_rt / n);
+    printf("Maximum response time = %d\n", max_rt);
+    printf("Boosts = %d\n", boosts);
+    printf("\tLevel\tQuantum\tAllotment\tResidency\tRun time\tDemoted\tFinished\n");
+    for (int k = 0; k < c->levels; k++)
+        printf("\t%d\t%d\t%d\t\t%lld (%.1f%%)\t%lld\t\t%d\t%d\n", k, mlfq_quantum(c, k),
+               mlfq_allotment(c, k), levels[k].residency,
+               total_residency > 0 ? 100.0 * levels[k].residency / total_residency : 0.0,
+               levels[k].run, levels[k].demotions, levels[k].finished);
+}
+
+// Print utilization, migrations and load imbalance of each core
+void printCores(int ncores, SmpCoreType cores[], SmpStatsType *stats)
+{
+    long long total_busy = 0, max_busy = 0;
+    float avg_busy;
+
+    for (int k = 0; k < ncores; k++) {
+        total_busy += cores[k].busy;
+        if (cores[k].busy > max_busy) max_busy = cores[k].busy;
+    }
+    avg_busy = (float)total_busy / ncores;
+
+    printf("Makespan = %lld\n", stats->makespan);
+    printf("Utilization = %.1f%%\n", stats->makespan > 0 ? 100.0 * avg_busy / stats->makespan : 0.0);
+    printf("Migrations = %d (stolen %d, balanced %d)\n", stats->steals + stats->balanced,
+           stats->steals, stats->balanced);
+    printf("Load imbalance = %.2f (busiest core over average)\n", avg_busy > 0 ? max_busy / avg_busy : 0.0);
+    printf("Average load spread = %.2f\n", stats->makespan > 0 ? (float)stats->spread / stats->makespan : 0.0);
+    printf("\tCore\tBusy\t\tUtilization\tOverhead\tCompleted\tStolen\tIn\tOut\n");
+    for (int k = 0; k < ncores; k++)
+        printf("\t%d\t%lld\t\t%.1f%%\t\t%lld\t\t%d\t\t%d\t%d\t%d\n", k, cores[k].busy,
+               stats->makespan > 0 ? 100.0 * cores[k].busy / stats->makespan : 0.0, cores[k].overhead,
+               cores[k].completed, cores[k].stolen, cores[k].migrated_in, cores[k].migrated_out);
+}
+
+// Print response times and how fairly CFS shared the CPU
+void printFairness(ProcessType plist[], int n, long long requeues)
+{
+    long long total_rt = 0;
+
+    for (int i = 0; i < n; i++)
+        total_rt += plist[i].rt;
+    printf("Average response time = %.2f\n", (float)total_rt / n);
+    printf("Requeues = %lld\n", requeues);
+    printf("Jain's fairness index = %.4f (weighted %.4f)\n", jainIndex(plist, n, 0), jainIndex(plist, n, 1));
+}
+
+// Print deadline misses and lateness of each task and of all their jobs
+void printDeadlines(RtTaskType tasks[], int n, RtTaskStatsType per_task[], RtStatsType *stats)
+{
+    printf("\tTask\tWCET\tPeriod\tDeadline\tJobs\tMissed\tMax lateness\tMax response\tAverage response\n");
+    for (int t = 0; t < n; t++) {
+        if (per_task[t].jobs == 0) {
+            printf("\t%d\t%d\t%d\t%d\t\t0\t0\t-\t\t-\t\t-\n", tasks[t].pid, tasks[t].wcet,
+                   tasks[t].period, tasks[t].deadline);
+            continue;
+        }
+        printf("\t%d\t%d\t%d\t%d\t\t%d\t%d\t%lld\t\t%lld\t\t%.2f\n", tasks[t].pid, tasks[t].wcet,
+               tasks[t].period, tasks[t].deadline, per_task[t].jobs, per_task[t].missed,
+               per_task[t].max_lateness, per_task[t].max_response,
+               (float)per_task[t].total_response / per_task[t].jobs);
+    }
+
+    printf("\nJobs = %d\n", stats->jobs);
+    printf("Deadline misses = %d (%.2f%%)\n", stats->missed,
+           stats->jobs > 0 ? 100.0 * stats->missed / stats->jobs : 0.0);
+    if (stats->jobs > 0)
+        printf("Maximum lateness = %lld\n", stats->max_lateness);
+    printf("Average lateness of missed jobs = %.2f\n",
+           stats->missed > 0 ? (float)stats->total_tardiness / stats->missed : 0.0);
+    printf("Preemptions = %lld\n", stats->preemptions);
+}
+
+// Print whether the utilization bounds, or response time analysis, show
+// that the tasks always meet their deadlines under policy
+void printSchedulable(RtTaskType tasks[], int n, int policy, RtVerdictType *v)
+{
+    char *results[] = { "unknown", "no", "yes" };
+
+    printf("Utilization = %.4f\n", v->utilization);
+    if (v->density != v->utilization)
+        printf("Density = %.4f\n", v->density);
+    if (policy == RT_RM)
+        printf("Liu & Layland bound = %.4f (%d tasks)\n", v->bound, n);
+    printf("Schedulable = %s (%s)\n", results[v->result + 1], v->test);
+    if (v->task != -1)
+        printf("Worst case response of task %d = %lld, over its deadline %d or period %d\n",
+               tasks[v->task].pid, v->response, tasks[v->task].deadline, tasks[v->task].period);
+}
+
+// Print context switches, utilization and throughput from the timeline of
+// a run, and with gantt its first segments
+void printTimeline(TimelineType *tl, ProcessType plist[], int n, int gantt)
+{
+    long long total_rt = 0;
+    int shown = tl->segments < TIMELINE_KEEP ? (int)tl->segments : TIMELINE_KEEP;
+
+    for (int i = 0; i < n; i++)
+        total_rt += plist[i].rt;
+    printf("Context switches = %lld\n", tl->switches);
+    printf("Switch overhead = %lld (%d per switch)\n", tl->overhead, tl->switch_cost);
+    printf("CPU utilization = %.1f%%\n", tl->end > 0 ? 100.0 * tl->busy / ((double)tl->end * tl->ncpus) : 0.0);
+    printf("Throughput = %.4f processes per time unit\n", tl->end > 0 ? (double)n / tl->end : 0.0);
+    printf("Average response time = %.2f\n", n > 0 ? (float)total_rt / n : 0.0);
+    if (!gantt) return;
+
+    printf("Timeline segments = %lld%s\n", tl->segments, tl->segments > shown ? " (first ones shown)" : "");
+    printf("\tCPU\tProcess\tStart\tEnd\n");
+    for (int k = 0; k < shown; k++) {
+        if (tl->kept[k].pid == -1)
+            printf("\t%d\tswitch\t%lld\t%lld\n", tl->kept[k].cpu, tl->kept[k].start, tl->kept[k].end);
+        else
+            printf("\t%d\tP%d\t%lld\t%lld\n", tl->kept[k].cpu, tl->kept[k].pid, tl->kept[k].start, tl->kept[k].end);
+    }
+}
+
+// Finish the timeline of a run, if it has one, and print what it shows
+void endTimeline(TimelineType *tl, ProcessType plist[], int n, int gantt)
+{
+    if (tl == NULL) return;
+    timeline_finish(tl);
+    printTimeline(tl, plist, n, gantt);
+    timeline_free(tl);
+}
+
+// Record the runs of a policy worked out from the waiting times, which
+// then take in the switch cost
+void replayProc(TimelineType *tl, ProcessType plist[], int n)
+{
+    ProcTable t;
+
+    if (tl == NULL) return;
+    table_init(&t, n);
+    table_load(&t, plist, n);
+    timeline_replay(tl, &t);
+    table_store(&t, plist, n);
+    table_free(&t);
+}
+
 // Initialize processes from file
 ProcessType * initProc(char *filename, int *n) 
 {
@@ -159,41 +280,262 @@ ProcessType * initProc(char *filename, int *n)
     return plist;
 }
   
+// Initialize real-time tasks from file
+RtTaskType * initTasks(char *filename, int *n) 
+{
+    FILE *input_file = fopen(filename, "r");
+    if (!input_file) {
+        fprintf(stderr, "Error: Invalid filepath\n");
+        exit(0);
+    }
+    RtTaskType *tasks = parse_tasks(input_file, n);
+    fclose(input_file);
+    return tasks;
+}
+
+// Copy the parsed processes over the ones a policy worked on, so the next
+// one starts from the file again without parsing it again
+void resetProc(ProcessType *plist, ProcessType *parsed, int n)
+{
+    memcpy(plist, parsed, n * sizeof(ProcessType));
+}
+
+// Run SMP once per core count, comparing them when there are several; with
+// timelines on, each run records one on trace
+void runSMP(ProcessType *proc_list, ProcessType *parsed, int n, SchedOptions *o, int timelines,
+            TraceFile *trace, int gantt)
+{
+    SmpConfig *c = &o->smp;
+    TimelineType timeline;
+    char name[32];
+    SmpCoreType *cores = malloc(SMP_MAX_CORES * sizeof(SmpCoreType));
+    SmpStatsType stats;
+    long long makespan[SMP_MAX_RUNS], total_wt, busy;
+    double awt[SMP_MAX_RUNS], util[SMP_MAX_RUNS];
+    int migrations[SMP_MAX_RUNS];
+
+    for (int r = 0; r < c->nruns; r++) {
+        resetProc(proc_list, parsed, n);
+        snprintf(name, sizeof(name), "SMP %d cores", c->cores[r]);
+        if (timelines)
+            timeline_init(&timeline, c->cores[r], o->switch_cost, trace, name);
+        findavgTimeSMP(proc_list, n, c->cores[r], o->quantum, c, cores, &stats, timelines ? &timeline : NULL);
+        printMetrics(proc_list, n);
+        printCores(c->cores[r], cores, &stats);
+        endTimeline(timelines ? &timeline : NULL, proc_list, n, gantt);
+
+        total_wt = busy = 0;
+        for (int i = 0; i < n; i++) total_wt += proc_list[i].wt;
+        for (int k = 0; k < c->cores[r]; k++) busy += cores[k].busy;
+        makespan[r] = stats.makespan;
+        awt[r] = (double)total_wt / n;
+        util[r] = stats.makespan > 0 ? 100.0 * busy / c->cores[r] / stats.makespan : 0.0;
+        migrations[r] = stats.steals + stats.balanced;
+    }
+    if (c->nruns > 1) {
+        printf("\n*********\nSMP Scaling\n");
+        printf("\tCores\tMakespan\tSpeedup\tAverage waiting time\tUtilization\tMigrations\n");
+        for (int r = 0; r < c->nruns; r++)
+            printf("\t%d\t%lld\t\t%.2f\t%.2f\t\t\t%.1f%%\t\t%d\n", c->cores[r], makespan[r],
+                   makespan[r] > 0 ? (double)makespan[0] / makespan[r] : 0.0, awt[r], util[r],
+                   migrations[r]);
+    }
+    free(cores);
+}
+
+// 1 when every algorithm is -EDF or -RM, 0 when none is and -1 when they
+// are mixed
+int realTimeAlgs(char *algs[], int nalgs)
+{
+    int rt = 0;
+
+    for (int a = 0; a < nalgs; a++)
+        if (strcmp(algs[a], "-EDF") == 0 || strcmp(algs[a], "-RM") == 0) rt++;
+    return rt == 0 ? 0 : rt == nalgs ? 1 : -1;
+}
+
+// Run EDF and rate monotonic on the tasks of filename, each over the same
+// horizon; with timelines on, each run records one on trace
+int runRealTime(char *filename, char *algs[], int nalgs, SchedOptions *o, int timelines,
+                TraceFile *trace, int gantt)
+{
+    int n = 0, bad, horizon, policy;
+    RtTaskType *tasks = initTasks(filename, &n);
+    RtTaskStatsType *per_task = malloc((n + 1) * sizeof(RtTaskStatsType));
+    RtStatsType stats;
+    RtVerdictType verdict;
+    TimelineType timeline;
+    ProcessType *jobs;
+    int status = 0;
+
+    bad = rt_check_tasks(tasks, n);
+    if (bad != -1) {
+        fprintf(stderr, "Error: Invalid task %d\n", tasks[bad].pid);
+        free(per_task);
+        free(tasks);
+        return 1;
+    }
+    horizon = rt_horizon(tasks, n, &o->rt);
+    for (int a = 0; a < nalgs; a++) {
+        policy = strcmp(algs[a], "-EDF") == 0 ? RT_EDF : RT_RM;
+        if (timelines)
+            timeline_init(&timeline, 1, o->switch_cost, trace, algs[a] + 1);
+        jobs = findavgTimeRT(tasks, n, policy, horizon, per_task, &stats, timelines ? &timeline : NULL);
+        if (jobs == NULL) {
+            fprintf(stderr, "Error: Horizon %d releases more than %d jobs\n", horizon, RT_MAX_JOBS);
+            if (timelines) timeline_free(&timeline);
+            status = 1;
+            break;
+        }
+        printDeadlines(tasks, n, per_task, &stats);
+        rt_schedulable(tasks, n, policy, &verdict);
+        printSchedulable(tasks, n, policy, &verdict);
+        endTimeline(timelines ? &timeline : NULL, jobs, stats.jobs, gantt);
+        free(jobs);
+    }
+    free(per_task);
+    free(tasks);
+    return status;
+}
+
 // Main driver function
+// With no algorithms given it runs FCFS, SJF, Priority and RR; otherwise
+// the ones given, in that order. Options with a value tune the policies,
+// and with any sweep option every run becomes one row of a comparison.
+// -GANTT, -TRACE= or a switch cost record a timeline of each run. -EDF and
+// -RM read the file as real-time tasks instead, and run on their own
 int main(int argc, char *argv[]) 
 { 
     int n; 
-    int quantum = 2;
-    ProcessType *proc_list;
+    ProcessType *proc_list, *parsed;
+    char *defaults[] = { "-FCFS", "-SJF", "-PRIORITY", "-RR" };
+    char **algs = malloc((argc + 4) * sizeof(char *));
+    int nalgs = 0;
+    SchedOptions opts;
+    SweepConfig sweep;
+    MlfqLevelType levels[MLFQ_MAX_LEVELS];
+    int boosts;
+    long long requeues;
+    TimelineType timeline, *tl;
+    TraceFile trace;
+    char *trace_path = NULL;
+    int gantt = 0, timelines, rt;
   
     if (argc < 2) {
-        fprintf(stderr, "Usage: ./schedsim <input-file-path>\n");
+        fprintf(stderr, "Usage: ./schedsim <input-file-path> [-FCFS] [-SJF] [-PRIORITY] [-RR] [-SRTF] [-MLFQ] [-SMP] [-CFS]\n"
+                        "\t[-QUANTUM=n] [-LEVELS=n] [-QUANTA=q0,q1,..] [-ALLOT=a0,a1,..] [-BOOST=n] [-DEMOTE=ALLOT|SLICE]\n"
+                        "\t[-CORES=n1,n2,..] [-STEAL=0|1] [-BALANCE=n] [-MIGRATION=n]\n"
+                        "\t[-LATENCY=n] [-GRANULARITY=n]\n"
+                        "\t[-EDF] [-RM] [-HORIZON=n]\n"
+                        "\t[-SWEEP=OPTION=lo-hi/step].. [-THREADS=n] [-CSV]\n"
+                        "\t[-SWITCH=n] [-GANTT] [-TRACE=file.json]\n");
         return 1;
     }
+    sched_default_options(&opts);
+    sweep_default_config(&sweep);
+    for (int a = 2; a < argc; a++) {
+        int taken = sched_parse_option(&opts, argv[a]);
+
+        if (taken == 0)
+            taken = sweep_parse_option(&sweep, &opts, argv[a]);
+        if (taken == 0 && strcmp(argv[a], "-GANTT") == 0) {
+            gantt = 1;
+            taken = 1;
+        }
+        if (taken == 0 && strncmp(argv[a], "-TRACE=", 7) == 0) {
+            trace_path = argv[a] + 7;
+            taken = *trace_path != '\0' ? 1 : -1;
+        }
+        if (taken < 0) {
+            fprintf(stderr, "Error: Invalid option %s\n", argv[a]);
+            return 1;
+        }
+        if (taken == 0)
+            algs[nalgs++] = argv[a];
+    }
+    if (nalgs == 0) {
+        memcpy(algs, defaults, sizeof(defaults));
+        nalgs = 4;
+    }
     
-    // FCFS
-    n = 0;
-    proc_list = initProc(argv[1], &n);
-    findavgTimeFCFS(proc_list, n);
-    printMetrics(proc_list, n);
-  
-    // SJF
-    n = 0;
-    proc_list = initProc(argv[1], &n);
-    findavgTimeSJF(proc_list, n); 
-    printMetrics(proc_list, n);
-  
-    // Priority
-    n = 0; 
-    proc_list = initProc(argv[1], &n);
-    findavgTimePriority(proc_list, n); 
-    printMetrics(proc_list, n);
+    rt = realTimeAlgs(algs, nalgs);
+    if (rt < 0 || (rt && sweep.enabled)) {
+        fprintf(stderr, "Error: -EDF and -RM run on a task file without other algorithms or sweeps\n");
+        return 1;
+    }
     
-    // RR
     n = 0;
-    proc_list = initProc(argv[1], &n);
-    findavgTimeRR(proc_list, n, quantum); 
-    printMetrics(proc_list, n);
+    parsed = rt ? NULL : initProc(argv[1], &n);
+    if (sweep.enabled) {
+        int status = runSweep(parsed, n, algs, nalgs, &opts, &sweep);
+
+        free(parsed);
+        free(algs);
+        return status < 0 ? 1 : 0;
+    }
+    timelines = gantt || trace_path != NULL || opts.switch_cost > 0;
+    if (trace_path != NULL && !trace_open(&trace, trace_path)) {
+        fprintf(stderr, "Error: Invalid filepath %s\n", trace_path);
+        return 1;
+    }
+    if (rt) {
+        int status = runRealTime(argv[1], algs, nalgs, &opts, timelines, trace_path != NULL ? &trace : NULL, gantt);
+
+        if (trace_path != NULL)
+            trace_close(&trace);
+        free(algs);
+        return status;
+    }
+    proc_list = malloc((n + 1) * sizeof(ProcessType));
+    for (int a = 0; a < nalgs; a++) {
+        resetProc(proc_list, parsed, n);
+        if (strcmp(algs[a], "-SMP") == 0) {
+            runSMP(proc_list, parsed, n, &opts, timelines, trace_path != NULL ? &trace : NULL, gantt);
+            continue;
+        }
+        tl = timelines ? &timeline : NULL;
+        if (tl != NULL)
+            timeline_init(tl, 1, opts.switch_cost, trace_path != NULL ? &trace : NULL, algs[a] + 1);
+        if (strcmp(algs[a], "-FCFS") == 0) {
+            findavgTimeFCFS(proc_list, n);
+            replayProc(tl, proc_list, n);
+        }
+        else if (strcmp(algs[a], "-SJF") == 0)
+            findavgTimeSJF(proc_list, n, tl); 
+        else if (strcmp(algs[a], "-PRIORITY") == 0) {
+            findavgTimePriority(proc_list, n); 
+            replayProc(tl, proc_list, n);
+        }
+        else if (strcmp(algs[a], "-RR") == 0)
+            findavgTimeRR(proc_list, n, opts.quantum, tl); 
+        else if (strcmp(algs[a], "-SRTF") == 0)
+            findavgTimeSRTF(proc_list, n, tl); 
+        else if (strcmp(algs[a], "-MLFQ") == 0) {
+            boosts = findavgTimeMLFQ(proc_list, n, &opts.mlfq, levels, tl); 
+            printMetrics(proc_list, n);
+            printLevels(proc_list, n, &opts.mlfq, levels, boosts);
+            endTimeline(tl, proc_list, n, gantt);
+            continue;
+        }
+        else if (strcmp(algs[a], "-CFS") == 0) {
+            requeues = findavgTimeCFS(proc_list, n, &opts.cfs, tl); 
+            printMetrics(proc_list, n);
+            printFairness(proc_list, n, requeues);
+            endTimeline(tl, proc_list, n, gantt);
+            continue;
+        }
+        else {
+            fprintf(stderr, "Error: Unknown algorithm %s\n", algs[a]);
+            return 1;
+        }
+        printMetrics(proc_list, n);
+        endTimeline(tl, proc_list, n, gantt);
+    }
+    if (trace_path != NULL)
+        trace_close(&trace);
+    free(proc_list);
+    free(parsed);
+    free(algs);
     
     return 0; 
 } 
\ No newline at end of file
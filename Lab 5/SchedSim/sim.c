@@ -0,0 +1,315 @@
+// Discrete-event engine for the scheduling simulations
+#include<stdio.h>
+#include<stdlib.h>
+#include "process.h"
+#include "sim.h"
+#include "timeline.h"
+
+static int event_before(EventType *a, EventType *b)
+{
+    if (a->time != b->time) return a->time < b->time;
+    if (a->type != b->type) return a->type < b->type;
+    return a->seq < b->seq;
+}
+
+void event_push(EventQueue *q, long long time, int type, int proc)
+{
+    int i = q->n++, parent;
+    EventType e = { time, type, proc, q->seq++ };
+
+    if (q->n > q->cap) {
+        q->cap = q->cap > 0 ? 2 * q->cap : 64;
+        q->heap = realloc(q->heap, q->cap * sizeof(EventType));
+    }
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!event_before(&e, &q->heap[parent])) break;
+        q->heap[i] = q->heap[parent];
+        i = parent;
+    }
+    q->heap[i] = e;
+}
+
+int event_pop(EventQueue *q, EventType *e)
+{
+    EventType last;
+    int i = 0, child;
+
+    if (q->n == 0) return 0;
+    *e = q->heap[0];
+    last = q->heap[--q->n];
+    while ((child = 2 * i + 1) < q->n) {
+        if (child + 1 < q->n && event_before(&q->heap[child + 1], &q->heap[child])) child++;
+        if (!event_before(&q->heap[child], &last)) break;
+        q->heap[i] = q->heap[child];
+        i = child;
+    }
+    q->heap[i] = last;
+    return 1;
+}
+
+static int proc_before(ProcHeap *h, int a, int b)
+{
+    if (h->key[a] != h->key[b]) return h->key[a] < h->key[b];
+    return a < b;
+}
+
+void proc_heap_push(ProcHeap *h, int p)
+{
+    int i = h->n++, parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!proc_before(h, p, h->heap[parent])) break;
+        h->heap[i] = h->heap[parent];
+        i = parent;
+    }
+    h->heap[i] = p;
+}
+
+int proc_heap_pop(ProcHeap *h)
+{
+    int top, last, i = 0, child;
+
+    if (h->n == 0) return -1;
+    top = h->heap[0];
+    last = h->heap[--h->n];
+    while ((child = 2 * i + 1) < h->n) {
+        if (child + 1 < h->n && proc_before(h, h->heap[child + 1], h->heap[child])) child++;
+        if (!proc_before(h, h->heap[child], last)) break;
+        h->heap[i] = h->heap[child];
+        i = child;
+    }
+    h->heap[i] = last;
+    return top;
+}
+
+void proc_fifo_push(ProcFifo *f, int i)
+{
+    int k;
+
+    if (f->n == f->cap) {
+        f->ring = realloc(f->ring, 2 * f->cap * sizeof(int));
+        for (k = 0; k < f->head; k++)      // the wrapped part goes after the rest
+            f->ring[f->cap + k] = f->ring[k];
+        f->cap *= 2;
+    }
+    f->ring[(f->head + f->n) % f->cap] = i;
+    f->n++;
+}
+
+int proc_fifo_pop(ProcFifo *f)
+{
+    int i;
+
+    if (f->n == 0) return -1;
+    i = f->ring[f->head];
+    f->head = (f->head + 1) % f->cap;
+    f->n--;
+    return i;
+}
+
+int proc_fifo_pop_back(ProcFifo *f)
+{
+    if (f->n == 0) return -1;
+    f->n--;
+    return f->ring[(f->head + f->n) % f->cap];
+}
+
+typedef struct arrival {
+    int art;
+    int proc;
+}ArrivalType;
+
+static int compareArrival(const void *a, const void *b)
+{
+    const ArrivalType *x = a, *y = b;
+
+    if (x->art != y->art) return x->art < y->art ? -1 : 1;
+    return x->proc - y->proc;
+}
+
+void sim_sort_arrivals(ProcessType plist[], int n, int order[])
+{
+    ArrivalType *a;
+    int i, sorted = 1;
+
+    for (i = 0; i < n; i++)
+        order[i] = i;
+    for (i = 1; i < n && sorted; i++)
+        sorted = plist[i - 1].art <= plist[i].art;
+    if (sorted) return;
+
+    a = malloc(n * sizeof(ArrivalType));
+    for (i = 0; i < n; i++) {
+        a[i].art = plist[i].art;
+        a[i].proc = i;
+    }
+    qsort(a, n, sizeof(ArrivalType), compareArrival);
+    for (i = 0; i < n; i++)
+        order[i] = a[i].proc;
+    free(a);
+}
+
+void sim_init(SimType *s, ProcessType plist[], int n, SimPolicy *policy, int use_arrival)
+{
+    int i;
+
+    s->plist = plist;
+    s->n = n;
+    s->policy = policy;
+    s->now = 0;
+    s->rem = malloc((n + 1) * sizeof(long long));
+    s->completion = calloc(n + 1, sizeof(long long));
+    s->first_run = malloc((n + 1) * sizeof(long long));
+    s->order = malloc((n + 1) * sizeof(int));
+    s->admitted = 0;
+    s->use_arrival = use_arrival;
+    s->events.heap = NULL;
+    s->events.n = 0;
+    s->events.cap = 0;
+    s->events.seq = 0;
+    s->heap.heap = malloc((n + 1) * sizeof(int));
+    s->heap.n = 0;
+    s->heap.key = s->rem;       // shortest remaining first unless the policy says otherwise
+    s->fifo.ring = malloc((n + 1) * sizeof(int));
+    s->fifo.head = 0;
+    s->fifo.n = 0;
+    s->fifo.cap = n + 1;
+    s->slice = policy->quantum;
+    s->running = -1;
+    s->dispatched = 0;
+    s->run_start = 0;
+    s->run_seq = -1;
+    s->nevents = 0;
+    s->preemptions = 0;
+    s->timeline = NULL;
+
+    for (i = 0; i < n; i++) {
+        s->rem[i] = plist[i].bt;
+        s->first_run[i] = -1;
+    }
+    if (use_arrival)
+        sim_sort_arrivals(plist, n, s->order);
+    else
+        for (i = 0; i < n; i++)
+            s->order[i] = i;
+}
+
+void sim_free(SimType *s)
+{
+    free(s->rem);
+    free(s->completion);
+    free(s->first_run);
+    free(s->order);
+    free(s->events.heap);
+    free(s->heap.heap);
+    free(s->fifo.ring);
+}
+
+// Gives the CPU to the next ready process until it completes or its quantum ends
+static void dispatch(SimType *s)
+{
+    int i, quantum, cost;
+
+    s->slice = s->policy->quantum;
+    i = s->policy->next(s);
+    quantum = s->slice;
+    if (i == -1) return;
+    cost = s->timeline != NULL ? timeline_dispatch(s->timeline, 0, s->plist[i].pid) : 0;
+    s->running = i;
+    s->dispatched = s->now;
+    s->run_start = s->now + cost;
+    if (s->first_run[i] == -1) s->first_run[i] = s->run_start;
+    s->run_seq = s->events.seq;
+    if (quantum > 0 && s->rem[i] > quantum)
+        event_push(&s->events, s->run_start + quantum, EVENT_PREEMPT, i);
+    else
+        event_push(&s->events, s->run_start + s->rem[i], EVENT_COMPLETION, i);
+}
+
+// Records the run of the running process, which stops now
+static void end_run(SimType *s)
+{
+    if (s->timeline != NULL)
+        timeline_run(s->timeline, 0, s->plist[s->running].pid, s->dispatched, s->run_start, s->now);
+}
+
+long long sim_running_rem(SimType *s)
+{
+    if (s->now <= s->run_start) return s->rem[s->running];    // still switching to it
+    return s->rem[s->running] - (s->now - s->run_start);
+}
+
+static long long next_arrival(SimType *s)
+{
+    int i;
+
+    if (s->admitted == s->n) return -1;
+    i = s->order[s->admitted];
+    return s->use_arrival ? s->plist[i].art : 0;
+}
+
+// Makes the next process in arrival order ready, preempting the running one if the policy says so
+static void admit(SimType *s)
+{
+    int i = s->order[s->admitted++];
+
+    if (s->rem[i] <= 0) {
+        s->completion[i] = s->now;    // nothing to run
+        return;
+    }
+    if (s->running != -1 && s->policy->preempts != NULL && sim_running_rem(s) > 0
+        && s->policy->preempts(s, i)) {
+        end_run(s);
+        s->rem[s->running] = sim_running_rem(s);
+        s->policy->ready(s, s->running);
+        s->running = -1;
+        s->run_seq = -1;              // its pending event is stale now
+        s->preemptions++;
+    }
+    s->policy->ready(s, i);
+}
+
+void sim_run(SimType *s)
+{
+    EventType e;
+    long long arrival;
+
+    for (;;) {
+        arrival = next_arrival(s);
+        if (arrival != -1 && (s->events.n == 0 || arrival <= s->events.heap[0].time)) {
+            s->now = arrival;
+            s->nevents++;
+            admit(s);
+        }
+        else if (!event_pop(&s->events, &e))
+            break;
+        else if (e.type == EVENT_TIMER) {
+            s->now = e.time;
+            s->nevents++;
+            s->policy->timer(s);
+        }
+        else if (e.seq == s->run_seq) {             // others end runs that were preempted
+            s->now = e.time;
+            s->nevents++;
+            end_run(s);
+            s->running = -1;
+            s->run_seq = -1;
+            if (e.type == EVENT_COMPLETION) {
+                s->rem[e.proc] = 0;
+                s->completion[e.proc] = s->now;
+            }
+            else {
+                s->rem[e.proc] -= s->now - s->run_start;
+                s->policy->ready(s, e.proc);
+            }
+        }
+
+        // every event of this instant is in before the CPU picks
+        arrival = next_arrival(s);
+        if (s->running == -1 && (arrival == -1 || arrival > s->now)
+            && (s->events.n == 0 || s->events.heap[0].time > s->now))
+            dispatch(s);
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "process.h"
+
+/**
+ * Discrete-event core of the scheduling simulations.
+ *
+ * Completions and preemptions are events in a min-heap ordered by time,
+ * and arrivals are admitted through a cursor over the processes sorted by
+ * arrival time, so the clock jumps from one event to the next instead of
+ * counting every time unit and a run costs O(events log n). A policy only
+ * says which ready process runs next and for how long: processes that
+ * become ready are handed to its ready callback and the CPU asks its next
+ * callback whenever it goes idle; next may change s->slice from the policy
+ * quantum for the process it picks. A preemptive policy also says whether a
+ * process that becomes ready takes the CPU from the running one; the
+ * pending event of the preempted run is then dropped when it comes up.
+ * Policies that act at set times push EVENT_TIMER events of their own.
+ * With a timeline the runs are recorded on it, and a run of a different
+ * process than the last one starts after the context switch cost.
+ */
+
+#define EVENT_ARRIVAL    0
+#define EVENT_COMPLETION 1
+#define EVENT_PREEMPT    2
+#define EVENT_TIMER      3     // pushed by a policy, handed to its timer callback
+
+typedef struct event {
+    long long time;
+    int type;          // EVENT_*, arrivals first among events at the same time
+    int proc;          // index into the process list
+    long long seq;     // order of scheduling, breaks the remaining ties
+}EventType;
+
+typedef struct event_queue {
+    EventType *heap;
+    int n;
+    int cap;
+    long long seq;
+}EventQueue;
+
+/* Min-heap of process indexes ordered by key[i], then by index. */
+typedef struct proc_heap {
+    int *heap;
+    int n;
+    long long *key;
+}ProcHeap;
+
+/* FIFO ring of process indexes, doubling when full. */
+typedef struct proc_fifo {
+    int *ring;
+    int head;
+    int n;
+    int cap;
+}ProcFifo;
+
+struct sim;
+struct timeline;
+
+typedef struct sim_policy {
+    void (*ready)(struct sim *s, int i);   // process i is ready to run
+    int (*next)(struct sim *s);            // ready process to run next, -1 when none
+    int quantum;                           // longest run before a preemption, 0 for none
+    int (*preempts)(struct sim *s, int i); // NULL, or whether i takes the CPU from s->running
+    void (*timer)(struct sim *s);          // NULL, or called on each EVENT_TIMER
+    void *data;                            // state of the policy
+}SimPolicy;
+
+typedef struct sim {
+    ProcessType *plist;
+    int n;
+    SimPolicy *policy;
+    long long now;
+    long long *rem;            // burst time left
+    long long *completion;
+    long long *first_run;      // -1 until the process first gets the CPU
+    int *order;                // process indexes by arrival time, then index
+    int admitted;              // processes of order that have arrived
+    int use_arrival;
+    EventQueue events;
+    ProcHeap heap;             // ready queues for the policies to use
+    ProcFifo fifo;
+    int slice;                 // longest run for the process next picks, set by next
+    int running;               // -1 while the CPU is idle
+    long long dispatched;      // when the running process got the CPU
+    long long run_start;       // when it started running, after any switch cost
+    long long run_seq;         // of the event ending the current run
+    long long nevents;
+    long long preemptions;
+    struct timeline *timeline; // NULL for none, set after sim_init
+}SimType;
+
+/* Sets up a simulation of the n processes of plist under policy. With
+ * use_arrival 0 every process is ready at time 0 and art is left to the
+ * caller. */
+void sim_init(SimType *s, ProcessType plist[], int n, SimPolicy *policy, int use_arrival);
+void sim_free(SimType *s);
+
+/* Runs the simulation until every process has completed, filling in
+ * s->completion. */
+void sim_run(SimType *s);
+
+/* Time the running process has left, counting the time it has run. */
+long long sim_running_rem(SimType *s);
+
+void event_push(EventQueue *q, long long time, int type, int proc);
+int event_pop(EventQueue *q, EventType *e);
+
+void proc_heap_push(ProcHeap *h, int i);
+int proc_heap_pop(ProcHeap *h);
+
+void proc_fifo_push(ProcFifo *f, int i);
+int proc_fifo_pop(ProcFifo *f);
+int proc_fifo_pop_back(ProcFifo *f);
+
+/* Fills order with the indexes of plist by arrival time, index order
+ * among equal arrival times. */
+void sim_sort_arrivals(ProcessType plist[], int n, int order[]);
+
+#endif				// SIM_H
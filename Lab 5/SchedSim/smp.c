@@ -0,0 +1,306 @@
+// Multi-core scheduling with per-CPU run queues and work stealing
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include "process.h"
+#include "sim.h"
+#include "smp.h"
+
+#define QUEUE_START 16
+
+typedef struct smp {
+    ProcessType *plist;
+    int n;
+    int ncores;
+    int quantum;
+    SmpConfig *cfg;
+    SmpCoreType *cores;
+    SmpStatsType *stats;
+    ProcFifo *queue;           // run queue of each core
+    int *running;              // process on each core, -1 while idle
+    int queued;                // processes in all the run queues
+    long long *dispatched;     // when the running process got the core
+    long long *run_start;      // when it started running, after any switch cost
+    long long *rem;
+    long long *completion;
+    long long *first_run;
+    int *core_of;
+    int *order;
+    int admitted;
+    int next_core;             // where the next arrival goes
+    EventQueue events;
+    TimelineType *timeline;
+    long long now;
+    long long last;            // load spread counted up to here
+}SmpState;
+
+void smp_default_config(SmpConfig *c)
+{
+    memset(c, 0, sizeof(SmpConfig));
+    c->cores[0] = 4;
+    c->nruns = 1;
+    c->steal = 1;
+    c->balance = 0;
+    c->migration = 1;
+}
+
+int smp_parse_option(SmpConfig *c, char *arg)
+{
+    char *s, *end;
+
+    if (strncmp(arg, "-CORES=", 7) == 0) {
+        c->nruns = 0;
+        for (s = arg + 7; ; s = end + 1) {
+            if (c->nruns == SMP_MAX_RUNS) return -1;
+            c->cores[c->nruns] = (int)strtol(s, &end, 10);
+            if (end == s || c->cores[c->nruns] < 1 || c->cores[c->nruns] > SMP_MAX_CORES) return -1;
+            c->nruns++;
+            if (*end == '\0') return 1;
+            if (*end != ',') return -1;
+        }
+    }
+    if (strncmp(arg, "-STEAL=", 7) == 0) {
+        c->steal = (int)strtol(arg + 7, &end, 10);
+        return *end == '\0' && (c->steal == 0 || c->steal == 1) ? 1 : -1;
+    }
+    if (strncmp(arg, "-BALANCE=", 9) == 0) {
+        c->balance = (int)strtol(arg + 9, &end, 10);
+        return *end == '\0' && c->balance >= 0 ? 1 : -1;
+    }
+    if (strncmp(arg, "-MIGRATION=", 11) == 0) {
+        c->migration = (int)strtol(arg + 11, &end, 10);
+        return *end == '\0' && c->migration >= 0 ? 1 : -1;
+    }
+    return 0;
+}
+
+static int load(SmpState *m, int c)
+{
+    return m->queue[c].n + (m->running[c] != -1);
+}
+
+// Adds the load spread since the last event, before anything changes at t
+static void advance(SmpState *m, long long t)
+{
+    int c, l, max = 0, min = -1;
+
+    if (t <= m->last) return;
+    for (c = 0; c < m->ncores; c++) {
+        l = load(m, c);
+        if (l > max) max = l;
+        if (min == -1 || l < min) min = l;
+    }
+    m->stats->spread += (max - min) * (t - m->last);
+    m->last = t;
+}
+
+static void migrate(SmpState *m, int i, int from, int to)
+{
+    m->rem[i] += m->cfg->migration;
+    m->cores[from].migrated_out++;
+    m->cores[to].migrated_in++;
+    m->cores[to].overhead += m->cfg->migration;
+    m->core_of[i] = to;
+}
+
+// Core with the most processes queued, lowest number among equals. Only
+// looked for while something is queued, so every steal that scans for it
+// takes a process
+static int busiest(SmpState *m)
+{
+    int c, best = 0;
+
+    for (c = 1; c < m->ncores; c++)
+        if (m->queue[c].n > m->queue[best].n) best = c;
+    return best;
+}
+
+static int steal(SmpState *m, int c)
+{
+    int from = busiest(m), i;
+
+    if (from == c || (i = proc_fifo_pop_back(&m->queue[from])) == -1) return -1;
+    m->queued--;
+    migrate(m, i, from, c);
+    m->cores[c].stolen++;
+    m->stats->steals++;
+    return i;
+}
+
+// Gives core c the next process of its queue, or when stealing one from
+// the busiest core
+static void dispatch(SmpState *m, int c, int stealing)
+{
+    int i = stealing ? steal(m, c) : proc_fifo_pop(&m->queue[c]), cost;
+
+    if (i == -1) return;
+    if (!stealing) m->queued--;
+    cost = m->timeline != NULL ? timeline_dispatch(m->timeline, c, m->plist[i].pid) : 0;
+    m->running[c] = i;
+    m->dispatched[c] = m->now;
+    m->run_start[c] = m->now + cost;
+    m->cores[c].overhead += cost;
+    if (m->first_run[i] == -1) m->first_run[i] = m->run_start[c];
+    if (m->rem[i] > m->quantum)
+        event_push(&m->events, m->run_start[c] + m->quantum, EVENT_PREEMPT, i);
+    else
+        event_push(&m->events, m->run_start[c] + m->rem[i], EVENT_COMPLETION, i);
+}
+
+// Moves queued processes from the most to the least loaded cores until
+// every load is within one of the others
+static void balance(SmpState *m)
+{
+    int c, max, min, i, work = m->admitted < m->n;
+
+    for (c = 0; c < m->ncores && !work; c++)
+        work = load(m, c) > 0;
+    if (!work) return;
+
+    for (;;) {
+        max = min = 0;
+        for (c = 1; c < m->ncores; c++) {
+            if (load(m, c) > load(m, max)) max = c;
+            if (load(m, c) < load(m, min)) min = c;
+        }
+        if (load(m, max) - load(m, min) <= 1) break;
+        i = proc_fifo_pop_back(&m->queue[max]);
+        migrate(m, i, max, min);
+        proc_fifo_push(&m->queue[min], i);
+        m->stats->balanced++;
+    }
+    event_push(&m->events, m->now + m->cfg->balance, EVENT_TIMER, -1);
+}
+
+static long long next_arrival(SmpState *m)
+{
+    if (m->admitted == m->n) return -1;
+    return m->plist[m->order[m->admitted]].art;
+}
+
+static void admit(SmpState *m)
+{
+    int i = m->order[m->admitted++];
+
+    if (m->rem[i] <= 0) {
+        m->completion[i] = m->now;    // nothing to run
+        return;
+    }
+    m->core_of[i] = m->next_core;
+    proc_fifo_push(&m->queue[m->next_core], i);
+    m->queued++;
+    m->next_core = (m->next_core + 1) % m->ncores;
+}
+
+static void finish_run(SmpState *m, EventType *e)
+{
+    int c = m->core_of[e->proc];
+
+    m->cores[c].busy += m->now - m->dispatched[c];
+    if (m->timeline != NULL)
+        timeline_run(m->timeline, c, m->plist[e->proc].pid, m->dispatched[c], m->run_start[c], m->now);
+    m->running[c] = -1;
+    if (e->type == EVENT_COMPLETION) {
+        m->rem[e->proc] = 0;
+        m->completion[e->proc] = m->now;
+        m->cores[c].completed++;
+    }
+    else {
+        m->rem[e->proc] -= m->now - m->run_start[c];
+        proc_fifo_push(&m->queue[c], e->proc);
+        m->queued++;
+    }
+}
+
+void findWaitingTimeSMP(ProcessType plist[], int n, int ncores, int quantum, SmpConfig *c,
+                        SmpCoreType cores[], SmpStatsType *stats, TimelineType *tl)
+{
+    SmpState m;
+    EventType e;
+    long long arrival;
+    int i, k;
+
+    memset(&m, 0, sizeof(SmpState));
+    m.plist = plist;
+    m.n = n;
+    m.ncores = ncores;
+    m.quantum = quantum;
+    m.cfg = c;
+    m.cores = cores;
+    m.stats = stats;
+    m.timeline = tl;
+    memset(cores, 0, ncores * sizeof(SmpCoreType));
+    memset(stats, 0, sizeof(SmpStatsType));
+    m.queue = malloc(ncores * sizeof(ProcFifo));
+    m.running = malloc(ncores * sizeof(int));
+    m.dispatched = calloc(ncores, sizeof(long long));
+    m.run_start = calloc(ncores, sizeof(long long));
+    for (k = 0; k < ncores; k++) {
+        m.queue[k].ring = malloc(QUEUE_START * sizeof(int));
+        m.queue[k].head = 0;
+        m.queue[k].n = 0;
+        m.queue[k].cap = QUEUE_START;
+        m.running[k] = -1;
+    }
+    m.rem = malloc((n + 1) * sizeof(long long));
+    m.completion = calloc(n + 1, sizeof(long long));
+    m.first_run = malloc((n + 1) * sizeof(long long));
+    m.core_of = calloc(n + 1, sizeof(int));
+    m.order = malloc((n + 1) * sizeof(int));
+    for (i = 0; i < n; i++) {
+        m.rem[i] = plist[i].bt;
+        m.first_run[i] = -1;
+    }
+    sim_sort_arrivals(plist, n, m.order);
+    if (c->balance > 0)
+        event_push(&m.events, c->balance, EVENT_TIMER, -1);
+
+    for (;;) {
+        arrival = next_arrival(&m);
+        if (arrival != -1 && (m.events.n == 0 || arrival <= m.events.heap[0].time)) {
+            advance(&m, arrival);
+            m.now = arrival;
+            admit(&m);
+        }
+        else if (!event_pop(&m.events, &e))
+            break;
+        else {
+            advance(&m, e.time);
+            m.now = e.time;
+            if (e.type == EVENT_TIMER)
+                balance(&m);
+            else
+                finish_run(&m, &e);
+        }
+
+        // every event of this instant is in before the idle cores pick,
+        // and they all look at their own queues before any steals, which
+        // stop once nothing is left queued anywhere
+        arrival = next_arrival(&m);
+        if ((arrival == -1 || arrival > m.now) && (m.events.n == 0 || m.events.heap[0].time > m.now)) {
+            for (k = 0; k < ncores && m.queued > 0; k++)
+                if (m.running[k] == -1) dispatch(&m, k, 0);
+            for (k = 0; k < ncores && c->steal && m.queued > 0; k++)
+                if (m.running[k] == -1) dispatch(&m, k, 1);
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        plist[i].wt = m.completion[i] - plist[i].art - plist[i].bt;
+        plist[i].rt = m.first_run[i] == -1 ? 0 : m.first_run[i] - plist[i].art;
+        if (m.completion[i] > stats->makespan) stats->makespan = m.completion[i];
+    }
+
+    for (k = 0; k < ncores; k++)
+        free(m.queue[k].ring);
+    free(m.queue);
+    free(m.running);
+    free(m.dispatched);
+    free(m.run_start);
+    free(m.rem);
+    free(m.completion);
+    free(m.first_run);
+    free(m.core_of);
+    free(m.order);
+    free(m.events.heap);
+}
@@ -0,0 +1,60 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include "process.h"
+#include "timeline.h"
+
+/**
+ * Scheduling on several CPUs, each with a run queue of its own.
+ *
+ * Arriving processes are dealt to the cores in turn and each core runs its
+ * queue round robin, so a process stays on its core unless it migrates. A
+ * core that goes idle steals the newest process queued on the busiest
+ * core, and every balance interval processes move from the most to the
+ * least loaded cores until their loads are within one of each other. A
+ * process pays the migration cost in extra run time each time it moves,
+ * and with a timeline a core pays the context switch cost before it runs
+ * a different process than the last one.
+ */
+
+#define SMP_MAX_CORES 1024
+#define SMP_MAX_RUNS 16
+
+typedef struct smp_config {
+    int cores[SMP_MAX_RUNS];   // core counts to simulate, one run each
+    int nruns;
+    int steal;                 // idle cores steal work when set
+    int balance;               // time between balancing passes, 0 for none
+    int migration;             // run time a process loses when it moves
+}SmpConfig;
+
+typedef struct smp_core {
+    long long busy;            // time running processes, migration and switch cost included
+    long long overhead;        // migration and switch cost paid here
+    int completed;
+    int stolen;                // processes this core took from others
+    int migrated_in;
+    int migrated_out;
+}SmpCoreType;
+
+typedef struct smp_stats {
+    long long makespan;
+    long long spread;          // time integral of the busiest minus the idlest core load
+    int steals;
+    int balanced;              // processes moved by balancing passes
+}SmpStatsType;
+
+void smp_default_config(SmpConfig *c);
+
+/* Applies a -CORES=, -STEAL=, -BALANCE= or -MIGRATION= option to c.
+ * Returns 1 when it took the option, 0 when it is not an SMP option and
+ * -1 when the value is invalid. */
+int smp_parse_option(SmpConfig *c, char *arg);
+
+/* Runs plist on ncores cores with quantum, filling in wt and rt, cores[]
+ * and stats, and records the runs on tl, of ncores CPUs, unless it is
+ * NULL. */
+void findWaitingTimeSMP(ProcessType plist[], int n, int ncores, int quantum, SmpConfig *c,
+                        SmpCoreType cores[], SmpStatsType *stats, TimelineType *tl);
+
+#endif				// SMP_H
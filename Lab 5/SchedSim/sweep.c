@@ -0,0 +1,425 @@
+// Parameter sweeps of the scheduling policies on a pool of threads
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<unistd.h>
+#include<pthread.h>
+#include "process.h"
+#include "sched.h"
+#include "mlfq.h"
+#include "smp.h"
+#include "cfs.h"
+#include "rt.h"
+#include "table.h"
+#include "timeline.h"
+#include "sweep.h"
+
+#define JOBS_START 64
+
+enum { ALG_FCFS, ALG_SJF, ALG_PRIORITY, ALG_RR, ALG_SRTF, ALG_MLFQ, ALG_SMP, ALG_CFS, NALGS };
+
+static char *alg_names[NALGS] = { "-FCFS", "-SJF", "-PRIORITY", "-RR", "-SRTF", "-MLFQ", "-SMP", "-CFS" };
+
+#define ALL_ALGS ((1 << NALGS) - 1)
+
+// Options a sweep can vary and the algorithms that take them. QUANTA and
+// ALLOT set the top MLFQ level, the levels below follow from it
+static struct {
+    char *name;
+    int algs;
+} params[] = {
+    { "QUANTUM", 1 << ALG_RR | 1 << ALG_SMP },
+    { "SWITCH", ALL_ALGS },
+    { "LEVELS", 1 << ALG_MLFQ },
+    { "QUANTA", 1 << ALG_MLFQ },
+    { "ALLOT", 1 << ALG_MLFQ },
+    { "BOOST", 1 << ALG_MLFQ },
+    { "CORES", 1 << ALG_SMP },
+    { "STEAL", 1 << ALG_SMP },
+    { "BALANCE", 1 << ALG_SMP },
+    { "MIGRATION", 1 << ALG_SMP },
+    { "LATENCY", 1 << ALG_CFS },
+    { "GRANULARITY", 1 << ALG_CFS },
+};
+
+#define NPARAMS (int)(sizeof(params) / sizeof(params[0]))
+
+typedef struct sweep_job {
+    int alg;
+    SchedOptions opts;
+    int ncores;                // of SMP
+    char label[192];           // values of the swept options
+    double awt;
+    double att;
+    double art;
+    int max_wt;
+    double jain;
+    long long switches;
+    double util;               // of the CPUs, in percent
+    long long ns;
+}SweepJob;
+
+typedef struct sweep_queue {
+    SweepJob *jobs;
+    int n;
+    int cap;
+    int next;                  // first job not taken yet
+    pthread_mutex_t lock;
+    ProcessType *parsed;       // shared, never written
+    ProcTable input;           // the same as columns, for the FCFS kernels
+    int nprocs;
+}SweepQueue;
+
+void sched_default_options(SchedOptions *o)
+{
+    o->quantum = 2;
+    o->switch_cost = 0;
+    mlfq_default_config(&o->mlfq);
+    smp_default_config(&o->smp);
+    cfs_default_config(&o->cfs);
+    rt_default_config(&o->rt);
+}
+
+int sched_parse_option(SchedOptions *o, char *arg)
+{
+    char *end;
+    int taken = mlfq_parse_option(&o->mlfq, arg);
+
+    if (taken == 0)
+        taken = smp_parse_option(&o->smp, arg);
+    if (taken == 0)
+        taken = cfs_parse_option(&o->cfs, arg);
+    if (taken == 0)
+        taken = rt_parse_option(&o->rt, arg);
+    if (taken == 0 && strncmp(arg, "-QUANTUM=", 9) == 0) {
+        o->quantum = (int)strtol(arg + 9, &end, 10);
+        taken = *end == '\0' && o->quantum > 0 ? 1 : -1;
+    }
+    if (taken == 0 && strncmp(arg, "-SWITCH=", 8) == 0) {
+        o->switch_cost = (int)strtol(arg + 8, &end, 10);
+        taken = *end == '\0' && o->switch_cost >= 0 ? 1 : -1;
+    }
+    return taken;
+}
+
+void sweep_default_config(SweepConfig *c)
+{
+    memset(c, 0, sizeof(SweepConfig));
+}
+
+static int find_param(char *name)
+{
+    for (int p = 0; p < NPARAMS; p++)
+        if (strcmp(params[p].name, name) == 0) return p;
+    return -1;
+}
+
+// Whether o takes the option of range r set to v
+static int valid_value(SchedOptions *o, SweepRange *r, int v)
+{
+    SchedOptions scratch = *o;
+    char arg[32];
+
+    snprintf(arg, sizeof(arg), "-%s=%d", r->name, v);
+    return sched_parse_option(&scratch, arg) == 1;
+}
+
+int sweep_parse_option(SweepConfig *c, SchedOptions *o, char *arg)
+{
+    SweepRange *r;
+    char *s, *end;
+    long long runs = 1;
+    int len;
+
+    if (strcmp(arg, "-CSV") == 0) {
+        c->csv = c->enabled = 1;
+        return 1;
+    }
+    if (strncmp(arg, "-THREADS=", 9) == 0) {
+        c->threads = (int)strtol(arg + 9, &end, 10);
+        c->enabled = 1;
+        return *end == '\0' && c->threads > 0 ? 1 : -1;
+    }
+    if (strncmp(arg, "-SWEEP=", 7) != 0) return 0;
+
+    // NAME=lo-hi/step, where -hi and /step may be left out
+    c->enabled = 1;
+    if (c->nranges == SWEEP_MAX_RANGES || (s = strchr(arg + 7, '=')) == NULL) return -1;
+    r = &c->ranges[c->nranges];
+    len = (int)(s - (arg + 7));
+    if (len >= (int)sizeof(r->name)) return -1;
+    memcpy(r->name, arg + 7, len);
+    r->name[len] = '\0';
+    if (find_param(r->name) == -1) return -1;
+
+    r->lo = (int)strtol(s + 1, &end, 10);
+    if (end == s + 1) return -1;
+    r->hi = r->lo;
+    r->step = 1;
+    if (*end == '-') {
+        s = end + 1;
+        r->hi = (int)strtol(s, &end, 10);
+        if (end == s) return -1;
+    }
+    if (*end == '/') {
+        s = end + 1;
+        r->step = (int)strtol(s, &end, 10);
+        if (end == s) return -1;
+    }
+    if (*end != '\0' || r->hi < r->lo || r->step < 1) return -1;
+    if (!valid_value(o, r, r->lo) || !valid_value(o, r, r->hi)) return -1;
+
+    // runs of a policy that takes every swept option
+    for (int k = 0; k <= c->nranges; k++)
+        runs *= ((long long)c->ranges[k].hi - c->ranges[k].lo) / c->ranges[k].step + 1;
+    if (runs > SWEEP_MAX_RUNS) return -1;
+    c->nranges++;
+    return 1;
+}
+
+static void add_job(SweepQueue *q, int alg, SchedOptions *o, int ncores, char *label)
+{
+    SweepJob *job;
+
+    if (q->n == q->cap) {
+        q->cap *= 2;
+        q->jobs = realloc(q->jobs, q->cap * sizeof(SweepJob));
+    }
+    job = &q->jobs[q->n++];
+    memset(job, 0, sizeof(SweepJob));
+    job->alg = alg;
+    job->opts = *o;
+    job->ncores = ncores;
+    snprintf(job->label, sizeof(job->label), "%s", label[0] != '\0' ? label : "-");
+}
+
+// Adds a job for every combination of the values of ranges r on that alg
+// takes, on top of the options o and their labels so far
+static void expand(SweepQueue *q, int alg, SchedOptions *o, SweepConfig *c, int r, char *label)
+{
+    SchedOptions next;
+    char arg[32], sub[192];
+    SweepRange *range;
+
+    if (r == c->nranges) {
+        if (alg != ALG_SMP) {
+            add_job(q, alg, o, 0, label);
+            return;
+        }
+        for (int k = 0; k < o->smp.nruns; k++) {
+            snprintf(sub, sizeof(sub), "%s%sCORES=%d", label, label[0] != '\0' ? " " : "", o->smp.cores[k]);
+            add_job(q, alg, o, o->smp.cores[k], strstr(label, "CORES=") ? label : sub);
+        }
+        return;
+    }
+
+    range = &c->ranges[r];
+    if (!(params[find_param(range->name)].algs & 1 << alg)) {
+        expand(q, alg, o, c, r + 1, label);
+        return;
+    }
+    // hi may be the largest int, past which v would wrap
+    for (long long v = range->lo; v <= range->hi; v += range->step) {
+        next = *o;
+        snprintf(arg, sizeof(arg), "-%s=%d", range->name, (int)v);
+        sched_parse_option(&next, arg);
+        snprintf(sub, sizeof(sub), "%s%s%s=%d", label, label[0] != '\0' ? " " : "", range->name, (int)v);
+        expand(q, alg, &next, c, r + 1, sub);
+    }
+}
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Switches and CPU utilization of a job from its timeline
+static void count_timeline(SweepJob *job, TimelineType *tl)
+{
+    timeline_finish(tl);
+    job->switches = tl->switches;
+    job->util = tl->end > 0 ? 100.0 * tl->busy / ((double)tl->end * tl->ncpus) : 0.0;
+    timeline_free(tl);
+}
+
+// Runs FCFS on the columns of t, which only reads bt and art, so nothing
+// needs copying first
+static void run_fcfs(SweepJob *job, ProcTable *t)
+{
+    long long start_ns = now_ns();
+    TimelineType tl;
+    int n = t->n;
+
+    timeline_init(&tl, 1, job->opts.switch_cost, NULL, "");
+    table_fcfs_wait(t);
+    table_turnaround(t);
+    timeline_replay(&tl, t);
+    job->ns = now_ns() - start_ns;
+    count_timeline(job, &tl);
+
+    if (n == 0) return;
+    job->awt = (double)table_sum(t->wt, n) / n;
+    job->att = (double)table_sum(t->tat, n) / n;
+    job->art = (double)table_sum(t->rt, n) / n;
+    job->max_wt = table_max(t->wt, n);
+    job->jain = table_jain(t, 0);
+}
+
+// Runs one job on plist, a copy of the parsed processes of its own
+static void run_job(SweepJob *job, ProcessType plist[], ProcessType parsed[], int n, SmpCoreType cores[])
+{
+    MlfqLevelType levels[MLFQ_MAX_LEVELS];
+    SmpStatsType stats;
+    TimelineType tl;
+    ProcTable replay;
+    long long start_ns, total_wt = 0, total_tat = 0, total_rt = 0;
+
+    memcpy(plist, parsed, n * sizeof(ProcessType));
+    timeline_init(&tl, job->alg == ALG_SMP ? job->ncores : 1, job->opts.switch_cost, NULL, "");
+    start_ns = now_ns();
+    switch (job->alg) {
+    case ALG_FCFS: findWaitingTime(plist, n); break;
+    case ALG_SJF: findWaitingTimeSJF(plist, n, &tl); break;
+    case ALG_PRIORITY: findWaitingTimePriority(plist, n); break;
+    case ALG_RR: findWaitingTimeRR(plist, n, job->opts.quantum, &tl); break;
+    case ALG_SRTF: findWaitingTimeSRTF(plist, n, &tl); break;
+    case ALG_MLFQ: findWaitingTimeMLFQ(plist, n, &job->opts.mlfq, levels, &tl); break;
+    case ALG_SMP:
+        findWaitingTimeSMP(plist, n, job->ncores, job->opts.quantum, &job->opts.smp, cores, &stats, &tl);
+        break;
+    case ALG_CFS: findWaitingTimeCFS(plist, n, &job->opts.cfs, &tl); break;
+    }
+    findTurnAroundTime(plist, n);
+    job->ns = now_ns() - start_ns;
+
+    if (job->alg == ALG_PRIORITY) {
+        table_init(&replay, n);
+        table_load(&replay, plist, n);
+        timeline_replay(&tl, &replay);
+        table_store(&replay, plist, n);
+        table_free(&replay);
+    }
+    count_timeline(job, &tl);
+
+    for (int i = 0; i < n; i++) {
+        total_wt += plist[i].wt;
+        total_tat += plist[i].tat;
+        total_rt += plist[i].rt;
+        if (plist[i].wt > job->max_wt) job->max_wt = plist[i].wt;
+    }
+    if (n == 0) return;
+    job->awt = (double)total_wt / n;
+    job->att = (double)total_tat / n;
+    job->art = (double)total_rt / n;
+    job->jain = jainIndex(plist, n, 0);
+}
+
+static void *worker(void *arg)
+{
+    SweepQueue *q = arg;
+    ProcessType *plist = malloc((q->nprocs + 1) * sizeof(ProcessType));
+    SmpCoreType *cores = malloc(SMP_MAX_CORES * sizeof(SmpCoreType));
+    ProcTable t = q->input;    // shares the input columns, with results of its own
+    int i;
+
+    t.wt = malloc((q->nprocs + 1) * sizeof(int));
+    t.tat = malloc((q->nprocs + 1) * sizeof(int));
+    t.rt = malloc((q->nprocs + 1) * sizeof(int));
+
+    for (;;) {
+        pthread_mutex_lock(&q->lock);
+        i = q->next < q->n ? q->next++ : -1;
+        pthread_mutex_unlock(&q->lock);
+
+        if (i == -1) break;
+        if (q->jobs[i].alg == ALG_FCFS)
+            run_fcfs(&q->jobs[i], &t);
+        else
+            run_job(&q->jobs[i], plist, q->parsed, q->nprocs, cores);
+    }
+    free(plist);
+    free(cores);
+    free(t.wt);
+    free(t.tat);
+    free(t.rt);
+    return NULL;
+}
+
+static void print_results(SweepQueue *q, int nthreads, long long wall_ns, int csv)
+{
+    long long cpu_ns = 0;
+    SweepJob *job;
+
+    if (csv)
+        printf("policy,parameters,processes,avg_wt,avg_tat,avg_rt,max_wt,jain,switches,utilization,ms\n");
+    else {
+        printf("\n*********\nSweep: %d runs of %d processes on %d threads\n", q->n, q->nprocs, nthreads);
+        printf("\t%-10s%-32s%12s%12s%12s%10s%8s%10s%8s%10s\n", "Policy", "Parameters", "Avg WT", "Avg TAT",
+               "Avg RT", "Max WT", "Jain", "Switches", "Util", "ms");
+    }
+    for (int i = 0; i < q->n; i++) {
+        job = &q->jobs[i];
+        cpu_ns += job->ns;
+        if (csv)
+            printf("%s,%s,%d,%.2f,%.2f,%.2f,%d,%.4f,%lld,%.2f,%.3f\n", alg_names[job->alg] + 1, job->label,
+                   q->nprocs, job->awt, job->att, job->art, job->max_wt, job->jain, job->switches, job->util,
+                   job->ns / 1e6);
+        else
+            printf("\t%-10s%-32s%12.2f%12.2f%12.2f%10d%8.4f%10lld%7.1f%%%10.2f\n", alg_names[job->alg] + 1,
+                   job->label, job->awt, job->att, job->art, job->max_wt, job->jain, job->switches, job->util,
+                   job->ns / 1e6);
+    }
+    if (!csv)
+        printf("Wall time = %.1f ms, run time of all jobs = %.1f ms (%.2fx)\n", wall_ns / 1e6, cpu_ns / 1e6,
+               wall_ns > 0 ? (double)cpu_ns / wall_ns : 0.0);
+}
+
+int runSweep(ProcessType parsed[], int n, char *algs[], int nalgs, SchedOptions *o, SweepConfig *c)
+{
+    SweepQueue q;
+    pthread_t *threads;
+    long long start_ns;
+    int nthreads = c->threads, alg, k;
+
+    q.n = 0;
+    q.cap = JOBS_START;
+    q.next = 0;
+    q.jobs = malloc(q.cap * sizeof(SweepJob));
+    q.parsed = parsed;
+    q.nprocs = n;
+    for (int a = 0; a < nalgs; a++) {
+        for (alg = 0; alg < NALGS && strcmp(algs[a], alg_names[alg]) != 0; alg++)
+            ;
+        if (alg == NALGS) {
+            fprintf(stderr, "Error: Unknown algorithm %s\n", algs[a]);
+            free(q.jobs);
+            return -1;
+        }
+        expand(&q, alg, o, c, 0, "");
+    }
+
+    if (nthreads == 0)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > q.n)
+        nthreads = q.n;
+    table_init(&q.input, n);
+    table_load(&q.input, parsed, n);
+    pthread_mutex_init(&q.lock, NULL);
+    threads = malloc(nthreads * sizeof(pthread_t));
+    start_ns = now_ns();
+    for (k = 0; k < nthreads; k++)
+        pthread_create(&threads[k], NULL, worker, &q);
+    for (k = 0; k < nthreads; k++)
+        pthread_join(threads[k], NULL);
+
+    print_results(&q, nthreads, now_ns() - start_ns, c->csv);
+    pthread_mutex_destroy(&q.lock);
+    table_free(&q.input);
+    free(threads);
+    free(q.jobs);
+    return 0;
+}
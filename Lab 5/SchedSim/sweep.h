@@ -0,0 +1,69 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "process.h"
+#include "mlfq.h"
+#include "smp.h"
+#include "cfs.h"
+#include "rt.h"
+
+/**
+ * Parameter sweeps over the scheduling policies.
+ *
+ * Each -SWEEP=NAME=lo-hi[/step] option gives a range of values for one of
+ * the integer options, and every policy runs once for each combination of
+ * the ranges of the options it takes, SMP also once per core count. The
+ * runs are independent jobs that a pool of threads takes from a shared
+ * queue, each thread working on its own copy of the parsed processes, and
+ * their results come out in one table, or as CSV, in job order.
+ */
+
+#define SWEEP_MAX_RANGES 8
+#define SWEEP_MAX_RUNS 100000  // of one policy over all the ranges
+
+typedef struct sched_options {
+    int quantum;           // of RR and SMP
+    int switch_cost;       // time a context switch takes, on the event engine
+    MlfqConfig mlfq;
+    SmpConfig smp;
+    CfsConfig cfs;
+    RtConfig rt;
+}SchedOptions;
+
+typedef struct sweep_range {
+    char name[16];         // option it sets, without the dash
+    int lo;
+    int hi;
+    int step;
+}SweepRange;
+
+typedef struct sweep_config {
+    SweepRange ranges[SWEEP_MAX_RANGES];
+    int nranges;
+    int threads;           // 0 for one per online CPU
+    int csv;
+    int enabled;           // any sweep option was given
+}SweepConfig;
+
+void sched_default_options(SchedOptions *o);
+
+/* Applies -QUANTUM=, -SWITCH= or an MLFQ, SMP, CFS or real-time option to
+ * o. Returns 1 when it took the option, 0 when it is none of those and -1
+ * when the value is invalid. */
+int sched_parse_option(SchedOptions *o, char *arg);
+
+void sweep_default_config(SweepConfig *c);
+
+/* Applies a -SWEEP=, -THREADS= or -CSV option to c, checking the range
+ * against o and that the ranges come to at most SWEEP_MAX_RUNS runs.
+ * Returns 1 when it took the option, 0 when it is not a sweep option and
+ * -1 when the value is invalid. */
+int sweep_parse_option(SweepConfig *c, SchedOptions *o, char *arg);
+
+/* Runs each of the nalgs algorithms (-FCFS, -RR, ...) on parsed for every
+ * combination of the ranges in c it takes, starting from o, and prints one
+ * row per run. Returns -1 without running any when an algorithm is
+ * unknown. */
+int runSweep(ProcessType parsed[], int n, char *algs[], int nalgs, SchedOptions *o, SweepConfig *c);
+
+#endif				// SWEEP_H
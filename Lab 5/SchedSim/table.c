@@ -0,0 +1,153 @@
+// Structure of arrays process table and the kernels that run over it
+#include<stdio.h>
+#include<stdlib.h>
+#include<limits.h>
+#ifdef __SSE2__
+#include<emmintrin.h>
+#endif
+#include "process.h"
+#include "cfs.h"
+#include "table.h"
+
+void table_init(ProcTable *t, int n)
+{
+    t->n = n;
+    t->pid = calloc(n + 1, sizeof(int));
+    t->bt = calloc(n + 1, sizeof(int));
+    t->art = calloc(n + 1, sizeof(int));
+    t->wt = calloc(n + 1, sizeof(int));
+    t->tat = calloc(n + 1, sizeof(int));
+    t->pri = calloc(n + 1, sizeof(int));
+    t->rt = calloc(n + 1, sizeof(int));
+}
+
+void table_free(ProcTable *t)
+{
+    free(t->pid);
+    free(t->bt);
+    free(t->art);
+    free(t->wt);
+    free(t->tat);
+    free(t->pri);
+    free(t->rt);
+}
+
+void table_load(ProcTable *t, ProcessType plist[], int n)
+{
+    for (int i = 0; i < n; i++) {
+        t->pid[i] = plist[i].pid;
+        t->bt[i] = plist[i].bt;
+        t->art[i] = plist[i].art;
+        t->wt[i] = plist[i].wt;
+        t->tat[i] = plist[i].tat;
+        t->pri[i] = plist[i].pri;
+        t->rt[i] = plist[i].rt;
+    }
+}
+
+void table_store(ProcTable *t, ProcessType plist[], int n)
+{
+    for (int i = 0; i < n; i++) {
+        plist[i].wt = t->wt[i];
+        plist[i].tat = t->tat[i];
+        plist[i].rt = t->rt[i];
+    }
+}
+
+void table_fcfs_wait(ProcTable *t)
+{
+    const int *bt = t->bt;
+    int *wt = t->wt;
+    int i = 0, n = t->n;
+
+    if (n == 0) return;
+#ifdef __SSE2__
+    // each block of four is scanned in the register in two shifted adds,
+    // and carry holds the sum of everything before it in every lane
+    __m128i carry = _mm_set1_epi32(t->art[0]);
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(bt + i));
+        __m128i x = _mm_add_epi32(b, _mm_slli_si128(b, 4));
+
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        _mm_storeu_si128((__m128i *)(wt + i), _mm_add_epi32(carry, _mm_sub_epi32(x, b)));
+        carry = _mm_add_epi32(carry, _mm_shuffle_epi32(x, 0xFF));
+    }
+#endif
+    for (; i < n; i++)
+        wt[i] = i == 0 ? t->art[0] : wt[i - 1] + bt[i - 1];
+    for (i = 0; i < n; i++)
+        t->rt[i] = wt[i];
+}
+
+void table_turnaround(ProcTable *t)
+{
+    const int *restrict bt = t->bt;
+    const int *restrict wt = t->wt;
+    int *restrict tat = t->tat;
+
+    for (int i = 0; i < t->n; i++)
+        tat[i] = bt[i] + wt[i];
+}
+
+long long table_sum(const int *v, int n)
+{
+    long long sum = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    // widened to 64 bit lanes by pairing each value with its sign
+    __m128i acc = _mm_setzero_si128();
+    long long lanes[2];
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+        __m128i sign = _mm_srai_epi32(x, 31);
+
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(x, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(x, sign));
+    }
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++)
+        sum += v[i];
+    return sum;
+}
+
+int table_max(const int *v, int n)
+{
+    int max = n > 0 ? INT_MIN : 0, i = 0;
+
+#ifdef __SSE2__
+    __m128i best = _mm_set1_epi32(max);
+    int lanes[4];
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+        __m128i gt = _mm_cmpgt_epi32(x, best);
+
+        best = _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, best));
+    }
+    _mm_storeu_si128((__m128i *)lanes, best);
+    for (int k = 0; k < 4; k++)
+        if (lanes[k] > max) max = lanes[k];
+#endif
+    for (; i < n; i++)
+        if (v[i] > max) max = v[i];
+    return max;
+}
+
+double table_jain(ProcTable *t, int weighted)
+{
+    double x, sum = 0, squares = 0;
+
+    for (int i = 0; i < t->n; i++) {
+        x = t->tat[i] > 0 ? (double)t->bt[i] / t->tat[i] : 1.0;
+        if (weighted) x = x * CFS_NICE_0_WEIGHT / cfs_weight(t->pri[i]);
+        sum += x;
+        squares += x * x;
+    }
+    return squares > 0 ? sum * sum / (t->n * squares) : 1.0;
+}
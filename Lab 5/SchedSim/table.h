@@ -0,0 +1,51 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "process.h"
+
+/**
+ * Process table with each field in an array of its own.
+ *
+ * A pass that reads one or two fields of every process, like summing the
+ * waiting times, then streams through only those arrays instead of whole
+ * ProcessType structs, and the kernels below run over them four lanes at
+ * a time with SSE2 where the compiler has it.
+ */
+
+typedef struct proc_table {
+    int n;
+    int *pid;
+    int *bt;
+    int *art;
+    int *wt;
+    int *tat;
+    int *pri;
+    int *rt;
+}ProcTable;
+
+/* Allocates the arrays of n processes, zeroed. */
+void table_init(ProcTable *t, int n);
+void table_free(ProcTable *t);
+
+/* Copies the fields of plist into t, which must hold n processes. */
+void table_load(ProcTable *t, ProcessType plist[], int n);
+
+/* Copies wt, tat and rt of t back into plist. */
+void table_store(ProcTable *t, ProcessType plist[], int n);
+
+/* FCFS in list order: the waiting time of each process is the arrival
+ * time of the first plus the bursts of those before it, a prefix sum of
+ * bt. Fills in wt and rt, as findWaitingTime does. */
+void table_fcfs_wait(ProcTable *t);
+
+/* tat = bt + wt for every process. */
+void table_turnaround(ProcTable *t);
+
+/* Sum and largest value of the n ints of v. */
+long long table_sum(const int *v, int n);
+int table_max(const int *v, int n);
+
+/* Jain's fairness index of t, as jainIndex. */
+double table_jain(ProcTable *t, int weighted);
+
+#endif				// TABLE_H
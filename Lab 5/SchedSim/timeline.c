@@ -0,0 +1,154 @@
+// Run-length encoded CPU timelines and their Chrome trace output
+#include<stdio.h>
+#include<stdlib.h>
+#include "process.h"
+#include "table.h"
+#include "timeline.h"
+
+int trace_open(TraceFile *f, char *path)
+{
+    f->out = fopen(path, "w");
+    f->events = 0;
+    f->runs = 0;
+    if (f->out == NULL) return 0;
+    fprintf(f->out, "{\"traceEvents\":[");
+    return 1;
+}
+
+void trace_close(TraceFile *f)
+{
+    fprintf(f->out, "\n]}\n");
+    fclose(f->out);
+}
+
+// Starts the next event of the trace, after a comma unless it is the first
+static FILE *trace_event(TraceFile *f)
+{
+    fprintf(f->out, "%s\n", f->events++ > 0 ? "," : "");
+    return f->out;
+}
+
+void timeline_init(TimelineType *t, int ncpus, int switch_cost, TraceFile *trace, char *name)
+{
+    t->ncpus = ncpus;
+    t->switch_cost = switch_cost;
+    t->trace = trace;
+    t->open = malloc(ncpus * sizeof(SegmentType));
+    t->last_pid = malloc(ncpus * sizeof(int));
+    for (int c = 0; c < ncpus; c++) {
+        t->open[c].end = -1;             // none open yet
+        t->last_pid[c] = -1;
+    }
+    t->segments = 0;
+    t->switches = 0;
+    t->busy = 0;
+    t->overhead = 0;
+    t->end = 0;
+    if (trace == NULL) return;
+
+    t->run = trace->runs++;
+    fprintf(trace_event(trace), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+            t->run, name);
+    for (int c = 0; c < ncpus; c++)
+        fprintf(trace_event(trace), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"CPU %d\"}}",
+                t->run, c, c);
+}
+
+// Counts a segment that will not grow any more and writes it out
+static void close_segment(TimelineType *t, SegmentType *s)
+{
+    if (t->segments < TIMELINE_KEEP) t->kept[t->segments] = *s;
+    t->segments++;
+    if (s->pid == -1) t->overhead += s->end - s->start;
+    else t->busy += s->end - s->start;
+    if (s->end > t->end) t->end = s->end;
+    if (t->trace == NULL) return;
+
+    if (s->pid == -1)
+        fprintf(trace_event(t->trace), "{\"name\":\"switch\",\"cat\":\"switch\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+                t->run, s->cpu, s->start, s->end - s->start);
+    else
+        fprintf(trace_event(t->trace), "{\"name\":\"P%d\",\"cat\":\"run\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+                s->pid, t->run, s->cpu, s->start, s->end - s->start);
+}
+
+// Extends the open segment of cpu when pid carries it on, or else closes
+// it and opens one for pid
+static void add_segment(TimelineType *t, int cpu, int pid, long long start, long long end)
+{
+    SegmentType *open = &t->open[cpu];
+
+    if (end <= start) return;
+    if (open->end == start && open->pid == pid) {
+        open->end = end;
+        return;
+    }
+    if (open->end != -1) close_segment(t, open);
+    open->cpu = cpu;
+    open->pid = pid;
+    open->start = start;
+    open->end = end;
+}
+
+static int compareStart(const void *a, const void *b)
+{
+    const SegmentType *x = a, *y = b;
+
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return x->cpu - y->cpu;
+}
+
+void timeline_finish(TimelineType *t)
+{
+    for (int c = 0; c < t->ncpus; c++) {
+        if (t->open[c].end != -1) close_segment(t, &t->open[c]);
+        t->open[c].end = -1;
+    }
+    // closed in the order they ended, which on several CPUs is not the order they started
+    qsort(t->kept, t->segments < TIMELINE_KEEP ? t->segments : TIMELINE_KEEP, sizeof(SegmentType), compareStart);
+}
+
+void timeline_free(TimelineType *t)
+{
+    free(t->open);
+    free(t->last_pid);
+}
+
+int timeline_dispatch(TimelineType *t, int cpu, int pid)
+{
+    int cost = 0;
+
+    if (t->last_pid[cpu] != -1 && t->last_pid[cpu] != pid) {
+        t->switches++;
+        cost = t->switch_cost;
+    }
+    t->last_pid[cpu] = pid;
+    return cost;
+}
+
+void timeline_run(TimelineType *t, int cpu, int pid, long long dispatched, long long start, long long end)
+{
+    // a run cut short by a preemption may not have got past its switch
+    add_segment(t, cpu, -1, dispatched, end < start ? end : start);
+    add_segment(t, cpu, pid, start, end);
+}
+
+void timeline_replay(TimelineType *t, ProcTable *p)
+{
+    long long end = 0, dispatched, start;
+    int cost;
+
+    for (int i = 0; i < p->n; i++) {
+        // the CPU gets to it once it is due and the one before is done
+        dispatched = i > 0 && end > p->wt[i] ? end : p->wt[i];
+        cost = p->bt[i] > 0 ? timeline_dispatch(t, 0, p->pid[i]) : 0;
+        start = dispatched + cost;
+        if (p->bt[i] > 0) {
+            timeline_run(t, 0, p->pid[i], dispatched, start, start + p->bt[i]);
+            end = start + p->bt[i];
+        }
+        p->tat[i] += start - p->wt[i];
+        p->rt[i] += start - p->wt[i];
+        p->wt[i] = (int)start;
+    }
+}
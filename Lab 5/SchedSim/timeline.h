@@ -0,0 +1,85 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include<stdio.h>
+#include "table.h"
+
+/**
+ * Timeline of what each CPU ran, and the context switch accounting that
+ * comes from it.
+ *
+ * The simulations report every run as a (cpu, pid, start, end) segment.
+ * A run that carries on where the last one on its CPU left off, by the
+ * same process, extends that segment instead of starting a new one, so a
+ * process that keeps getting its quantum back shows as one segment. A
+ * dispatch of a different process than the last one its CPU ran is a
+ * context switch, and costs switch_cost time units of CPU before the
+ * process starts; those show as switch segments with a pid of -1.
+ *
+ * Only the last segment of each CPU and the first TIMELINE_KEEP of the
+ * run are held in memory. The others go straight to the trace file, when
+ * there is one, so a run of millions of segments takes no more memory
+ * than a short one.
+ */
+
+#define TIMELINE_KEEP 64       // segments kept to print as a chart
+
+typedef struct segment {
+    int cpu;
+    int pid;                   // -1 for a context switch
+    long long start;
+    long long end;
+}SegmentType;
+
+/* Chrome trace event JSON file, written as segments come in. Each
+ * timeline written to it shows as one process with a thread per CPU. */
+typedef struct trace_file {
+    FILE *out;
+    int events;                // written so far
+    int runs;                  // timelines started
+}TraceFile;
+
+typedef struct timeline {
+    int ncpus;
+    int switch_cost;
+    TraceFile *trace;          // NULL for none
+    int run;                   // id of the timeline in trace
+    SegmentType *open;         // last segment of each CPU, not written yet
+    int *last_pid;             // process each CPU ran last, -1 for none
+    SegmentType kept[TIMELINE_KEEP];
+    long long segments;
+    long long switches;
+    long long busy;            // time running processes
+    long long overhead;        // time switching between them
+    long long end;             // of the last segment
+}TimelineType;
+
+/* Opens path for a trace and writes its header. Returns 0 when it cannot
+ * be opened. */
+int trace_open(TraceFile *f, char *path);
+void trace_close(TraceFile *f);
+
+/* Starts a timeline of ncpus CPUs under name, written to trace unless it
+ * is NULL. */
+void timeline_init(TimelineType *t, int ncpus, int switch_cost, TraceFile *trace, char *name);
+
+/* Writes out the open segments once the simulation is over. */
+void timeline_finish(TimelineType *t);
+void timeline_free(TimelineType *t);
+
+/* CPU cpu is about to run pid. Counts a context switch when the CPU ran
+ * another process last, and returns the time it costs. */
+int timeline_dispatch(TimelineType *t, int cpu, int pid);
+
+/* pid got the CPU at dispatched, ran from start after the switch and
+ * stopped at end. */
+void timeline_run(TimelineType *t, int cpu, int pid, long long dispatched, long long start, long long end);
+
+/* Records the runs of a policy worked out in closed form, each process in
+ * list order from wt to wt + bt, and charges the switch cost: a process
+ * that comes after a switch starts that much later, and so does every
+ * one after it that did not wait for its arrival anyway. wt, tat and rt
+ * are moved by as much as the start. */
+void timeline_replay(TimelineType *t, ProcTable *p);
+
+#endif				// TIMELINE_H
@@ -3,37 +3,162 @@
 #include<unistd.h>
 #include<stdlib.h>
 #include<errno.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
 
 #include "util.h"
 #include "process.h"
 
+#define READ_CHUNK (1 << 20)
+#define MAX_FIELDS 6
+
+// Adds a record with fields v to an array of them, doubling it when full
+typedef void *(*Appender)(void *records, int *n, int *cap, int v[]);
+
+// Reads the rest of f into memory, for input that cannot be mapped
+static char *read_all(FILE *f, size_t *size)
+{
+	size_t cap = READ_CHUNK, got;
+	char *buf = malloc(cap);
+
+	*size = 0;
+	while ((got = fread(buf + *size, 1, cap - *size, f)) > 0) {
+		*size += got;
+		if (*size == cap) {
+			cap *= 2;
+			buf = realloc(buf, cap);
+		}
+	}
+	return buf;
+}
+
+static int is_space(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static void *append_process(void *records, int *n, int *cap, int v[])
+{
+	ProcessType *pptr = records;
+
+	if (*n == *cap) {
+		*cap *= 2;
+		pptr = realloc(pptr, *cap * sizeof(ProcessType));
+	}
+	pptr[*n].pid = v[0];
+	pptr[*n].bt = v[1];
+	pptr[*n].art = v[2];
+	pptr[*n].wt = v[3];
+	pptr[*n].tat = v[4];
+	pptr[*n].pri = v[5];
+	pptr[*n].rt = 0;
+	*n += 1;
+	return pptr;
+}
+
+static void *append_task(void *records, int *n, int *cap, int v[])
+{
+	RtTaskType *tptr = records;
+
+	if (*n == *cap) {
+		*cap *= 2;
+		tptr = realloc(tptr, *cap * sizeof(RtTaskType));
+	}
+	tptr[*n].pid = v[0];
+	tptr[*n].wcet = v[1];
+	tptr[*n].phase = v[2];
+	tptr[*n].period = v[3];
+	tptr[*n].deadline = v[4];
+	tptr[*n].jitter = v[5];
+	*n += 1;
+	return tptr;
+}
+
 /**
- * Returns an array of process that are parsed from
- * the input file descriptor passed as argument
- * CAUTION: You need to free up the space that is allocated
- * by this function
+ * Parses the whitespace separated integers of data, fields to a record
+ * in the order of the input file columns, into a growable array of
+ * records of size bytes. Stops at the first thing that is not an integer;
+ * a last record with missing fields gets 0 for them.
  */
-ProcessType *parse_file(FILE * f, int *P_SIZE)
+static void *parse_buffer(const char *data, size_t size, int fields, size_t width, Appender append, int *count)
 {
-	int i = 0;
+	const char *p = data, *end = data + size;
+	int cap = 1024, n = 0, field = 0, v[MAX_FIELDS] = { 0 };
+	void *pptr = malloc(cap * width);
 
-  ProcessType *pptr = (ProcessType *) malloc(sizeof(ProcessType));
-  
-  // count the number of processes
-  while (!feof(f)) {
-		fscanf(f, "%d %d %d %d %d %d\n", &(pptr->pid), &(pptr->bt), &(pptr->art), &(pptr->wt), &(pptr->tat), &(pptr->pri));
-    *P_SIZE += 1;
+	for (;;) {
+		unsigned int x = 0;
+		int negative = 0;
+		const char *digits;
+
+		while (p < end && is_space(*p)) p++;
+		if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+		digits = p;
+		while (p < end && *p >= '0' && *p <= '9')
+			x = x * 10 + (unsigned int)(*p++ - '0');
+		if (p == digits) break;
+		v[field++] = negative ? -(int)x : (int)x;
+		if (field == fields) {
+			pptr = append(pptr, &n, &cap, v);
+			field = 0;
+		}
+	}
+
+	if (field > 0) {
+		while (field < fields) v[field++] = 0;
+		pptr = append(pptr, &n, &cap, v);
 	}
+	*count += n;
+	return pptr;
+}
+
+// Parses the rest of f in a single pass over the file mapped into memory,
+// or read in when it cannot be mapped
+static void *parse_input(FILE *f, int fields, size_t width, Appender append, int *P_SIZE)
+{
+	struct stat st;
+	void *pptr;
+	char *data = MAP_FAILED;
+	size_t size = 0;
+	off_t offset = ftello(f);
 
-  free(pptr);
-  fseek(f, 0, SEEK_SET);  // reset file pointer to beginning of fils
-  
-	// read all the data
-	pptr = (ProcessType *) calloc(*P_SIZE, sizeof(ProcessType));
-	while (!feof(f)) {
-		fscanf(f, "%d %d %d %d %d %d\n", &(pptr[i].pid), &(pptr[i].bt), &(pptr[i].art), &(pptr[i].wt), &(pptr[i].tat), &(pptr[i].pri));
-		i++;
+	if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && offset >= 0 && st.st_size > offset) {
+		data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fileno(f), 0);
+		if (data != MAP_FAILED) {
+			size = st.st_size;
+			madvise(data, size, MADV_SEQUENTIAL);
+			pptr = parse_buffer(data + offset, size - offset, fields, width, append, P_SIZE);
+			munmap(data, size);
+			return pptr;
+		}
 	}
 
+	data = read_all(f, &size);
+	pptr = parse_buffer(data, size, fields, width, append, P_SIZE);
+	free(data);
 	return pptr;
-}
\ No newline at end of file
+}
+
+/**
+ * Returns an array of process that are parsed from
+ * the input file descriptor passed as argument, in a single pass
+ * over the file mapped into memory (or read in, when it cannot be
+ * mapped)
+ * CAUTION: You need to free up the space that is allocated
+ * by this function
+ */
+ProcessType *parse_file(FILE * f, int *P_SIZE)
+{
+	return parse_input(f, 6, sizeof(ProcessType), append_process, P_SIZE);
+}
+
+/**
+ * Returns the tasks of a task file, one per line as
+ * pid wcet phase period deadline jitter
+ * CAUTION: You need to free up the space that is allocated
+ * by this function
+ */
+RtTaskType *parse_tasks(FILE * f, int *n)
+{
+	return parse_input(f, 6, sizeof(RtTaskType), append_task, n);
+}
@@ -8,5 +8,6 @@
  */
 
 ProcessType *parse_file(FILE *, int *);
+RtTaskType *parse_tasks(FILE *, int *);
 
 #endif				// UTIL_H
\ No newline at end of file
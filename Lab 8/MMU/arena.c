@@ -0,0 +1,235 @@
+// arena.c
+//
+// Multi-arena heap with per-thread caches of small blocks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "util.h"
+#include "memory.h"
+#include "arena.h"
+
+#define CACHED_MAX    (ARENA_CLASSES * ARENA_CLASS_SIZE)
+
+static void arena_lock(arena_t *a){
+  long long start;
+
+  if(pthread_mutex_trylock(&a->lock) != 0){
+    start = now_ns();
+    pthread_mutex_lock(&a->lock);
+    a->contended += 1;
+    a->wait_ns += now_ns() - start;
+  }
+  a->acquisitions += 1;
+  a->locked_at = now_ns();
+}
+
+static void arena_unlock(arena_t *a){
+  a->hold_ns += now_ns() - a->locked_at;
+  pthread_mutex_unlock(&a->lock);
+}
+
+/* takes a block from arena i, under its lock */
+static int arena_allocate(heap_t *h, int i, int handle, int blocksize){
+  arena_t *a = &h->arenas[i];
+  int result;
+
+  arena_lock(a);
+  result = memory_allocate(a->memory, handle, blocksize);
+  if(result == 0)
+    a->allocs += 1;
+  arena_unlock(a);
+  return result;
+}
+
+static void slot_lock(pid_slot_t *slot){
+  while(__atomic_test_and_set(&slot->lock, __ATOMIC_ACQUIRE))
+    ;
+}
+
+static void slot_unlock(pid_slot_t *slot){
+  __atomic_clear(&slot->lock, __ATOMIC_RELEASE);
+}
+
+/* counts an allocation of the PID, chaining its block unless it failed */
+static void slot_add(heap_t *h, pid_slot_t *slot, int handle){
+  slot_lock(slot);
+  if(handle != 0){
+    h->blocks[handle].next = 0;
+    if(slot->head == 0)
+      slot->head = handle;
+    else
+      h->blocks[slot->tail].next = handle;
+    slot->tail = handle;
+  }
+  slot->allocs += 1;
+  slot_unlock(slot);
+}
+
+static void arena_deallocate(heap_t *h, int i, int handle){
+  arena_t *a = &h->arenas[i];
+
+  arena_lock(a);
+  if(memory_deallocate(a->memory, handle) == 0)
+    a->frees += 1;
+  arena_unlock(a);
+}
+
+heap_t *heap_alloc(int size, int policy, int narenas, int central_percent, int nthreads,
+                   int cache_limit, int large, int max_pid, int max_handle){
+  heap_t *h = malloc(sizeof(heap_t));
+  int central = (int)((long long)size * central_percent / 100);
+  int i;
+
+  h->narenas = narenas;
+  h->cache_limit = cache_limit;
+  h->large = large;
+  h->nthreads = nthreads;
+  h->max_pid = max_pid;
+  h->pids = calloc(max_pid + 1, sizeof(pid_slot_t));
+  h->blocks = calloc(max_handle + 1, sizeof(held_block_t));
+
+  if(posix_memalign((void **)&h->arenas, 64, (narenas + 1) * sizeof(arena_t)) != 0 ||
+     posix_memalign((void **)&h->threads, 64, nthreads * sizeof(heap_thread_t)) != 0){
+    fprintf(stderr, "Error: Memory Allocation for %d arenas\n", narenas);
+    exit(1);
+  }
+  memset(h->arenas, 0, (narenas + 1) * sizeof(arena_t));
+  memset(h->threads, 0, nthreads * sizeof(heap_thread_t));
+
+  for(i = 0; i <= narenas; i++){
+    h->arenas[i].memory = memory_alloc(i < narenas ? (size - central) / narenas : central,
+                                       policy, MEMORY_QUIET);
+    pthread_mutex_init(&h->arenas[i].lock, NULL);
+  }
+
+  for(i = 0; i < nthreads; i++){
+    h->threads[i].id = i;
+    h->threads[i].home = i % narenas;
+    h->threads[i].cache.bins = malloc(ARENA_CLASSES * (cache_limit > 0 ? cache_limit : 1) * sizeof(cached_block_t));
+  }
+
+  return h;
+}
+
+void heap_free(heap_t *h){
+  int i;
+
+  for(i = 0; i <= h->narenas; i++){
+    memory_free(h->arenas[i].memory);
+    pthread_mutex_destroy(&h->arenas[i].lock);
+  }
+  for(i = 0; i < h->nthreads; i++)
+    free(h->threads[i].cache.bins);
+  free(h->arenas);
+  free(h->threads);
+  free(h->pids);
+  free(h->blocks);
+  free(h);
+}
+
+int heap_allocate(heap_t *h, int thread, int pid, int blocksize, int handle){
+  heap_thread_t *t = &h->threads[thread];
+  pid_slot_t *slot = &h->pids[pid];
+  cached_block_t *bin;
+  int class = -1, arena = -1, i;
+
+  t->allocs += 1;
+
+  if(h->cache_limit > 0 && blocksize > 0 && blocksize <= CACHED_MAX){
+    class = (blocksize - 1) / ARENA_CLASS_SIZE;
+    blocksize = (class + 1) * ARENA_CLASS_SIZE;
+    if(t->cache.count[class] > 0){     // no lock taken
+      bin = &t->cache.bins[class * h->cache_limit];
+      t->cache.count[class] -= 1;
+      t->cache_hits += 1;
+      handle = bin[t->cache.count[class]].handle;
+      h->blocks[handle].thread = thread;
+      h->blocks[handle].arena = bin[t->cache.count[class]].arena;
+      h->blocks[handle].size = blocksize;
+      slot_add(h, slot, handle);
+      return 0;
+    }
+    t->cache_misses += 1;
+  }
+
+  if(blocksize > h->large){
+    if(arena_allocate(h, h->narenas, handle, blocksize) == 0)
+      arena = h->narenas;
+  }
+  else{
+    for(i = 0; i < h->narenas && arena == -1; i++){
+      if(arena_allocate(h, (t->home + i) % h->narenas, handle, blocksize) == 0)
+        arena = (t->home + i) % h->narenas;
+    }
+    if(arena != -1 && arena != t->home)
+      t->fallbacks += 1;
+  }
+
+  if(arena == -1){
+    t->alloc_failures += 1;
+    slot_add(h, slot, 0);
+    return -1;
+  }
+
+  h->blocks[handle].thread = thread;
+  h->blocks[handle].arena = arena;
+  h->blocks[handle].size = blocksize;
+  slot_add(h, slot, handle);
+  return 0;
+}
+
+int heap_deallocate(heap_t *h, int thread, int pid, int allocs){
+  heap_thread_t *t = &h->threads[thread];
+  pid_slot_t *slot;
+  held_block_t *b;
+  cached_block_t *bin;
+  int handle, class;
+
+  if(pid < 0 || pid > h->max_pid){
+    t->free_failures += 1;
+    return -1;
+  }
+  slot = &h->pids[pid];
+  slot_lock(slot);
+  if(slot->allocs < allocs){
+    slot_unlock(slot);
+    return 1;
+  }
+  handle = slot->head;
+  if(handle != 0)
+    slot->head = h->blocks[handle].next;
+  slot_unlock(slot);
+  if(handle == 0){
+    t->free_failures += 1;
+    return -1;
+  }
+
+  b = &h->blocks[handle];
+  t->frees += 1;
+  if(b->thread != thread)
+    t->cross_frees += 1;
+
+  // the block keeps its place in the arena while it sits in the cache
+  if(h->cache_limit > 0 && b->size <= CACHED_MAX){
+    class = (b->size - 1) / ARENA_CLASS_SIZE;
+    if(t->cache.count[class] < h->cache_limit){
+      bin = &t->cache.bins[class * h->cache_limit];
+      bin[t->cache.count[class]].handle = handle;
+      bin[t->cache.count[class]].arena = b->arena;
+      t->cache.count[class] += 1;
+      return 0;
+    }
+  }
+
+  arena_deallocate(h, b->arena, handle);
+  return 0;
+}
+
+void heap_coalesce(heap_t *h, int i){
+  arena_lock(&h->arenas[i]);
+  memory_coalesce(h->arenas[i].memory);
+  arena_unlock(&h->arenas[i]);
+}
@@ -0,0 +1,114 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <pthread.h>
+
+#include "memory.h"
+
+/**
+ * Multi-arena heap for the mmu_arena simulator, shaped like the allocators
+ * of threaded C libraries.
+ *
+ * The partition is split into a central arena for large requests and a set
+ * of arenas shared out among the threads, each a memory_t of its own behind
+ * a mutex. Small requests are rounded up to a size class and first look in
+ * the thread's cache, a handful of freed blocks per class that are reused
+ * without taking any lock. A miss goes to the thread's home arena, and to
+ * the other arenas in turn when that one is full.
+ *
+ * Blocks are known to the arenas by a handle, not by the trace PID, since a
+ * cached block keeps its place in the arena while it moves between PIDs.
+ * A PID may hold several blocks, chained in the order they were allocated,
+ * and each free gives back the oldest, one block per free as in mmu. Any
+ * thread may free any PID; a free made by another thread than the
+ * allocating one is counted as a cross-thread free.
+ */
+
+#define ARENA_CLASS_SIZE    16      // spacing of the cached size classes
+#define ARENA_CLASSES       64      // so requests of up to 1024 bytes are cached
+
+
+typedef struct arena {
+  memory_t *memory;
+  pthread_mutex_t lock;
+  long long acquisitions;
+  long long contended;       // acquisitions that found the lock taken
+  long long wait_ns;         // spent waiting for the lock
+  long long hold_ns;         // spent holding it
+  long long locked_at;
+  long long allocs;
+  long long frees;
+}__attribute__((aligned(64))) arena_t;     // a cache line each, so arenas do not share one
+
+typedef struct cached_block {
+  int handle;
+  int arena;
+}cached_block_t;
+
+typedef struct tcache {
+  int count[ARENA_CLASSES];
+  cached_block_t *bins;      // ARENA_CLASSES bins of limit entries
+}tcache_t;
+
+typedef struct held_block {
+  int thread;                // that allocated it
+  int arena;
+  int size;                  // bytes taken from the arena, rounded to the class
+  int next;                  // handle of the next block of the PID, 0 for none
+}held_block_t;
+
+typedef struct pid_slot {
+  char lock;                 // spin lock over the rest
+  int allocs;                // allocations made for the PID, failed ones too
+  int head;                  // oldest block held, 0 for none
+  int tail;
+}pid_slot_t;
+
+typedef struct heap_thread {
+  int id;
+  int home;                  // arena tried first
+  tcache_t cache;
+  long long allocs;
+  long long alloc_failures;
+  long long cache_hits;
+  long long cache_misses;
+  long long fallbacks;       // small requests served by another arena than home
+  long long frees;
+  long long cross_frees;     // of blocks allocated by another thread
+  long long deferred;        // frees retried because the allocation had not happened yet
+  long long free_failures;
+}__attribute__((aligned(64))) heap_thread_t;
+
+typedef struct heap {
+  int narenas;               // not counting the central one, arenas[narenas]
+  arena_t *arenas;
+  int cache_limit;           // blocks per size class and thread, 0 disables the caches
+  int large;                 // requests above this go to the central arena
+  int nthreads;
+  heap_thread_t *threads;
+  int max_pid;
+  pid_slot_t *pids;
+  held_block_t *blocks;      // by handle
+}heap_t;
+
+/* Splits size bytes into a central arena of central_percent and narenas
+ * equal arenas, all run by policy. Handles run from 1 to max_handle. */
+heap_t *heap_alloc(int size, int policy, int narenas, int central_percent, int nthreads,
+                   int cache_limit, int large, int max_pid, int max_handle);
+void heap_free(heap_t *h);
+
+/* Allocates blocksize bytes for pid on behalf of thread. handle must be
+ * unique among the handles given so far, and above 0. Returns 0 on success
+ * and -1 when no arena could satisfy the request. */
+int heap_allocate(heap_t *h, int thread, int pid, int blocksize, int handle);
+
+/* Frees the oldest block of pid on behalf of thread, a free that comes
+ * after the first allocs allocations of pid in the trace. Returns 0 on
+ * success, 1 when those allocations have not all happened yet so the free
+ * must be retried later, and -1 when pid holds no memory. */
+int heap_deallocate(heap_t *h, int thread, int pid, int allocs);
+
+/* Coalesces arena i under its lock. */
+void heap_coalesce(heap_t *h, int i);
+
+#endif				// ARENA_H
@@ -0,0 +1,319 @@
+// arenasim.c
+//
+// Replays a trace through a multi-arena heap with several threads at once.
+// Records are dealt out by PID, so each thread replays the allocations and
+// frees of its own PIDs in trace order while the others do the same. With
+// -MIGRATE some PIDs are freed by the next thread instead, as in producer
+// and consumer code, which makes those frees cross-thread. A free that
+// reaches its thread before the allocations of its PID that come ahead of
+// it in the trace have happened elsewhere is put aside and retried. Lock contention and hold times are printed per arena,
+// cache hits and cross-thread frees per thread.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "util.h"
+#include "memory.h"
+#include "trace.h"
+#include "arena.h"
+
+#define RETRY_EVERY 64     // records between passes over the frees put aside
+
+typedef struct options {
+  int policy;
+  char *name;
+  int threads;
+  int arenas;
+  int cache_limit;
+  int large;
+  int central;
+  int migrate;
+}options_t;
+
+typedef struct stream {
+  heap_t *heap;
+  trace_t *trace;
+  int thread;
+  int *records;            // indexes into the trace, in trace order
+  int *allocs;             // of the PID of each free before it in the trace
+  int n;
+}stream_t;
+
+static struct {
+  char *name;
+  int policy;
+} policies[] = {
+  { "F", POLICY_FIRSTFIT },
+  { "B", POLICY_BESTFIT },
+  { "W", POLICY_WORSTFIT },
+  { "N", POLICY_NEXTFIT },
+  { "BUDDY", POLICY_BUDDY },
+  { "TLSF", POLICY_TLSF },
+  { "BITMAP", POLICY_BITMAP },
+};
+
+static int finished;       // threads through their stream, read and written atomically
+
+void print_usage(){
+  printf("usage: ./mmu_arena <input file> -{F | B | W | N | BUDDY | TLSF | BITMAP} [-THREADS=<n>] [-ARENAS=<n>] [-TCACHE=<blocks>] [-LARGE=<bytes>] [-CENTRAL=<percent>] [-MIGRATE=<percent>]\n");
+  printf("  -THREADS  threads replaying the trace, PIDs are dealt out by pid %% threads (default 4)\n");
+  printf("  -ARENAS   arenas shared out among the threads (default one per thread)\n");
+  printf("  -TCACHE   cached free blocks per size class and thread, 0 for none (default 7)\n");
+  printf("  -LARGE    requests above this go to the central arena (default 4096)\n");
+  printf("  -CENTRAL  share of the partition given to the central arena (default 25)\n");
+  printf("  -MIGRATE  percent of the PIDs freed by another thread than the allocating one (default 0)\n");
+}
+
+void get_options(int argc, char *args[], options_t *opt){
+  int i, j;
+
+  for(i = 2; i < argc; i++)
+    for(j = 0; args[i][j] != '\0'; j++)
+      args[i][j] = toupper(args[i][j]);
+
+  opt->policy = 0;
+  for(i = 0; i < (int)(sizeof(policies) / sizeof(policies[0])); i++){
+    if(strcmp(args[2] + 1, policies[i].name) == 0){
+      opt->policy = policies[i].policy;
+      opt->name = policies[i].name;
+    }
+  }
+  if(args[2][0] != '-' || opt->policy == 0){
+    print_usage();
+    exit(1);
+  }
+
+  opt->threads = 4;
+  opt->arenas = 0;
+  opt->cache_limit = 7;
+  opt->large = 4096;
+  opt->central = 25;
+  opt->migrate = 0;
+  for(i = 3; i < argc; i++){
+    if(sscanf(args[i], "-THREADS=%d", &opt->threads) == 1 && opt->threads > 0)
+      continue;
+    else if(sscanf(args[i], "-ARENAS=%d", &opt->arenas) == 1 && opt->arenas > 0)
+      continue;
+    else if(sscanf(args[i], "-TCACHE=%d", &opt->cache_limit) == 1 && opt->cache_limit >= 0)
+      continue;
+    else if(sscanf(args[i], "-LARGE=%d", &opt->large) == 1 && opt->large > 0)
+      continue;
+    else if(sscanf(args[i], "-CENTRAL=%d", &opt->central) == 1 && opt->central > 0 && opt->central < 100)
+      continue;
+    else if(sscanf(args[i], "-MIGRATE=%d", &opt->migrate) == 1 && opt->migrate >= 0 && opt->migrate <= 100)
+      continue;
+    else {
+      print_usage();
+      exit(1);
+    }
+  }
+  if(opt->arenas == 0)
+    opt->arenas = opt->threads;
+}
+
+/* same PIDs migrate on every run */
+static int migrates(int pid, int percent){
+  return (int)(((unsigned int)pid * 2654435761u >> 16) % 100) < percent;
+}
+
+/* frees the block of record i of the stream */
+static int stream_free(stream_t *s, int i){
+  return heap_deallocate(s->heap, s->thread, -s->trace->ops[s->records[i]][0], s->allocs[i]);
+}
+
+/* Retries the frees put aside, records of the stream. Returns the number
+ * still waiting. */
+static int retry_frees(stream_t *s, int *pending, int n){
+  int i, kept = 0;
+
+  for(i = 0; i < n; i++){
+    if(stream_free(s, pending[i]) == 1)
+      pending[kept++] = pending[i];
+  }
+  return kept;
+}
+
+void *replay(void *arg){
+  stream_t *s = arg;
+  heap_t *h = s->heap;
+  int *pending = malloc((s->n + 1) * sizeof(int));
+  int npending = 0, last, i, j, pid;
+
+  for(i = 0; i < s->n; i++){
+    pid = s->trace->ops[s->records[i]][0];
+    if(pid == -99999){
+      for(j = s->thread; j <= h->narenas; j += h->nthreads)
+        heap_coalesce(h, j);
+    }
+    else if(pid > 0)
+      heap_allocate(h, s->thread, pid, s->trace->ops[s->records[i]][1], s->records[i] + 1);
+    else if(stream_free(s, i) == 1){
+      h->threads[s->thread].deferred += 1;
+      pending[npending++] = i;
+    }
+
+    if(npending > 0 && i % RETRY_EVERY == 0)
+      npending = retry_frees(s, pending, npending);
+  }
+
+  // once every thread is through its stream, every allocation has happened
+  __atomic_add_fetch(&finished, 1, __ATOMIC_RELEASE);
+  while(npending > 0){
+    last = __atomic_load_n(&finished, __ATOMIC_ACQUIRE) == h->nthreads;
+    npending = retry_frees(s, pending, npending);
+    if(last){
+      h->threads[s->thread].free_failures += npending;
+      break;
+    }
+    sched_yield();
+  }
+
+  free(pending);
+  return NULL;
+}
+
+static double percent(long long part, long long whole){
+  return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+void print_report(heap_t *h, options_t *opt, int size, long long records, long long run_ns){
+  heap_thread_t *t, total;
+  arena_t *a;
+  memory_t *m;
+  int i;
+
+  printf("Threads: %d, arenas: %d + central (%d%% of %d bytes), cache %d blocks per class up to %d bytes, large > %d bytes, policy %s\n",
+         opt->threads, opt->arenas, opt->central, size, opt->cache_limit, ARENA_CLASSES * ARENA_CLASS_SIZE,
+         opt->large, opt->name);
+  printf("Records: %lld in %.3f ms (%.0f ops/sec)\n\n", records, run_ns / 1e6, run_ns > 0 ? records * 1e9 / run_ns : 0.0);
+
+  printf("%8s%10s%10s%11s%11s%10s%10s%10s%10s\n", "thread", "allocs", "failed", "cache hit", "fallbacks",
+         "frees", "cross", "deferred", "failed");
+  memset(&total, 0, sizeof(total));
+  for(i = 0; i <= h->nthreads; i++){
+    t = i < h->nthreads ? &h->threads[i] : &total;
+    if(i < h->nthreads)
+      printf("%8d", i);
+    else
+      printf("%8s", "total");
+    printf("%10lld%10lld%10.1f%%%11lld%10lld%10lld%10lld%10lld\n", t->allocs, t->alloc_failures,
+           percent(t->cache_hits, t->cache_hits + t->cache_misses), t->fallbacks, t->frees, t->cross_frees,
+           t->deferred, t->free_failures);
+
+    total.allocs += t->allocs;
+    total.alloc_failures += t->alloc_failures;
+    total.cache_hits += t->cache_hits;
+    total.cache_misses += t->cache_misses;
+    total.fallbacks += t->fallbacks;
+    total.frees += t->frees;
+    total.cross_frees += t->cross_frees;
+    total.deferred += t->deferred;
+    total.free_failures += t->free_failures;
+  }
+
+  printf("\n%8s%10s%10s%10s%10s%11s%10s%10s%13s%12s%10s\n", "arena", "size", "allocs", "frees", "locks",
+         "contended", "wait ms", "hold ms", "avg hold ns", "free bytes", "ext frag");
+  for(i = 0; i <= h->narenas; i++){
+    a = &h->arenas[i];
+    m = a->memory;
+    if(i < h->narenas)
+      printf("%8d", i);
+    else
+      printf("%8s", "central");
+    printf("%10d%10lld%10lld%10lld%10.1f%%%10.1f%10.1f%13.0f%12d%9.1f%%\n", m->size, a->allocs, a->frees,
+           a->acquisitions, percent(a->contended, a->acquisitions), a->wait_ns / 1e6, a->hold_ns / 1e6,
+           a->acquisitions > 0 ? (double)a->hold_ns / a->acquisitions : 0.0, memory_free_bytes(m),
+           memory_external_frag(m));
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  options_t OPTIONS;
+  FILE *INPUT;
+  trace_t *TRACE;
+  heap_t *HEAP;
+  stream_t *streams;
+  pthread_t *threads;
+  int record[2], size, max_pid = 0, pid, i, t;
+  int *allocs;
+  long long start_ns, run_ns;
+
+  if(argc < 3) {
+    print_usage();
+    exit(1);
+  }
+
+  get_options(argc, argv, &OPTIONS);
+
+  INPUT = fopen(argv[1], "r");
+  if (!INPUT) {
+    fprintf(stderr, "Error: Invalid filepath\n");
+    exit(0);
+  }
+
+  // the whole trace is read first, so the threads do not wait on the file
+  parse_partition(INPUT, &size);
+  TRACE = trace_alloc(size);
+  while(parse_record(INPUT, record)){
+    trace_add(TRACE, record[0], record[1]);
+    if(abs(record[0]) > max_pid && record[0] != -99999)
+      max_pid = abs(record[0]);
+  }
+  fclose(INPUT);
+
+  streams = calloc(OPTIONS.threads, sizeof(stream_t));
+  for(t = 0; t < OPTIONS.threads; t++){
+    streams[t].trace = TRACE;
+    streams[t].thread = t;
+    streams[t].records = malloc((TRACE->n + 1) * sizeof(int));
+    streams[t].allocs = malloc((TRACE->n + 1) * sizeof(int));
+  }
+  allocs = calloc(max_pid + 1, sizeof(int));
+  for(i = 0; i < TRACE->n; i++){
+    pid = TRACE->ops[i][0];
+    if(pid > 0)
+      allocs[pid] += 1;
+    if(pid == -99999){
+      for(t = 0; t < OPTIONS.threads; t++)
+        streams[t].records[streams[t].n++] = i;
+      continue;
+    }
+    t = abs(pid) % OPTIONS.threads;
+    if(pid < 0 && migrates(-pid, OPTIONS.migrate))
+      t = (t + 1) % OPTIONS.threads;
+    streams[t].allocs[streams[t].n] = pid < 0 ? allocs[-pid] : 0;
+    streams[t].records[streams[t].n++] = i;
+  }
+  free(allocs);
+
+  HEAP = heap_alloc(size, OPTIONS.policy, OPTIONS.arenas, OPTIONS.central, OPTIONS.threads,
+                    OPTIONS.cache_limit, OPTIONS.large, max_pid, TRACE->n);
+  threads = malloc(OPTIONS.threads * sizeof(pthread_t));
+
+  start_ns = now_ns();
+  for(t = 0; t < OPTIONS.threads; t++){
+    streams[t].heap = HEAP;
+    pthread_create(&threads[t], NULL, replay, &streams[t]);
+  }
+  for(t = 0; t < OPTIONS.threads; t++)
+    pthread_join(threads[t], NULL);
+  run_ns = now_ns() - start_ns;
+
+  print_report(HEAP, &OPTIONS, size, TRACE->n, run_ns);
+
+  for(t = 0; t < OPTIONS.threads; t++){
+    free(streams[t].records);
+    free(streams[t].allocs);
+  }
+  free(streams);
+  free(threads);
+  heap_free(HEAP);
+  trace_free(TRACE);
+
+  return 0;
+}
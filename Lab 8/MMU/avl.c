@@ -0,0 +1,170 @@
+// avl.c
+//
+// Intrusive AVL tree used to index free blocks.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "avl.h"
+
+static int height(avl_node_t *n){
+  return n != NULL ? n->height : 0;
+}
+
+static void update(avl_node_t *n, const avl_ops_t *ops){
+  int hl = height(n->left), hr = height(n->right);
+
+  n->height = 1 + (hl > hr ? hl : hr);
+  if(ops->value != NULL){
+    n->max = n->min = ops->value(n);
+    if(n->left != NULL && n->left->max > n->max)
+      n->max = n->left->max;
+    if(n->right != NULL && n->right->max > n->max)
+      n->max = n->right->max;
+    if(n->left != NULL && n->left->min < n->min)
+      n->min = n->left->min;
+    if(n->right != NULL && n->right->min < n->min)
+      n->min = n->right->min;
+  }
+}
+
+static avl_node_t *rotate_right(avl_node_t *y, const avl_ops_t *ops){
+  avl_node_t *x = y->left;
+
+  y->left = x->right;
+  x->right = y;
+  update(y, ops);
+  update(x, ops);
+  return x;
+}
+
+static avl_node_t *rotate_left(avl_node_t *x, const avl_ops_t *ops){
+  avl_node_t *y = x->right;
+
+  x->right = y->left;
+  y->left = x;
+  update(x, ops);
+  update(y, ops);
+  return y;
+}
+
+static avl_node_t *rebalance(avl_node_t *n, const avl_ops_t *ops){
+  int balance;
+
+  update(n, ops);
+  balance = height(n->left) - height(n->right);
+
+  if(balance > 1){
+    if(height(n->left->left) < height(n->left->right))
+      n->left = rotate_left(n->left, ops);
+    return rotate_right(n, ops);
+  }
+  if(balance < -1){
+    if(height(n->right->right) < height(n->right->left))
+      n->right = rotate_right(n->right, ops);
+    return rotate_left(n, ops);
+  }
+  return n;
+}
+
+avl_node_t *avl_insert(avl_node_t *root, avl_node_t *n, const avl_ops_t *ops){
+  if(root == NULL){
+    n->left = n->right = NULL;
+    update(n, ops);
+    return n;
+  }
+
+  if(ops->cmp(n, root) < 0)
+    root->left = avl_insert(root->left, n, ops);
+  else
+    root->right = avl_insert(root->right, n, ops);
+  return rebalance(root, ops);
+}
+
+static avl_node_t *remove_first(avl_node_t *root, avl_node_t **first, const avl_ops_t *ops){
+  if(root->left == NULL){
+    *first = root;
+    return root->right;
+  }
+  root->left = remove_first(root->left, first, ops);
+  return rebalance(root, ops);
+}
+
+avl_node_t *avl_remove(avl_node_t *root, avl_node_t *n, const avl_ops_t *ops){
+  avl_node_t *successor;
+
+  if(root == NULL)
+    return NULL;
+
+  if(root == n){
+    if(root->left == NULL)
+      return root->right;
+    if(root->right == NULL)
+      return root->left;
+
+    // replace the node with the smallest node of its right subtree
+    successor = NULL;
+    root->right = remove_first(root->right, &successor, ops);
+    successor->left = root->left;
+    successor->right = root->right;
+    return rebalance(successor, ops);
+  }
+
+  if(ops->cmp(n, root) < 0)
+    root->left = avl_remove(root->left, n, ops);
+  else
+    root->right = avl_remove(root->right, n, ops);
+  return rebalance(root, ops);
+}
+
+avl_node_t *avl_lower_bound(avl_node_t *root, const avl_node_t *key, const avl_ops_t *ops){
+  avl_node_t *found = NULL;
+
+  while(root != NULL){
+    if(ops->cmp(root, key) >= 0){
+      found = root;
+      root = root->left;
+    }
+    else
+      root = root->right;
+  }
+  return found;
+}
+
+avl_node_t *avl_predecessor(avl_node_t *root, const avl_node_t *key, const avl_ops_t *ops){
+  avl_node_t *found = NULL;
+
+  while(root != NULL){
+    if(ops->cmp(root, key) < 0){
+      found = root;
+      root = root->right;
+    }
+    else
+      root = root->left;
+  }
+  return found;
+}
+
+avl_node_t *avl_first(avl_node_t *root){
+  if(root != NULL){
+    while(root->left != NULL)
+      root = root->left;
+  }
+  return root;
+}
+
+avl_node_t *avl_last(avl_node_t *root){
+  if(root != NULL){
+    while(root->right != NULL)
+      root = root->right;
+  }
+  return root;
+}
+
+void avl_walk(avl_node_t *root, void (*visit)(avl_node_t *n, void *arg), void *arg){
+  if(root == NULL)
+    return;
+  avl_walk(root->left, visit, arg);
+  visit(root, arg);
+  avl_walk(root->right, visit, arg);
+}
@@ -0,0 +1,43 @@
+#ifndef AVL_H
+#define AVL_H
+
+#include <stddef.h>
+
+/**
+ * Intrusive AVL tree. A structure joins a tree by embedding an avl_node_t and
+ * the tree only ever hands back pointers to those members; use AVL_ENTRY to
+ * get the enclosing structure. Keys must be unique under the comparison.
+ */
+
+#define AVL_ENTRY(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+
+typedef struct avl_node {
+  struct avl_node *left;
+  struct avl_node *right;
+  int height;
+  int max;        // largest and smallest ops->value() in this subtree,
+  int min;        // kept only if ops->value is set
+}avl_node_t;
+
+typedef struct avl_ops {
+  int (*cmp)(const avl_node_t *a, const avl_node_t *b);
+  int (*value)(const avl_node_t *n);   // optional subtree max/min augmentation
+}avl_ops_t;
+
+/* Insert and remove return the new root of the tree. */
+avl_node_t *avl_insert(avl_node_t *root, avl_node_t *n, const avl_ops_t *ops);
+avl_node_t *avl_remove(avl_node_t *root, avl_node_t *n, const avl_ops_t *ops);
+
+/* Smallest node that does not compare below key, or NULL. */
+avl_node_t *avl_lower_bound(avl_node_t *root, const avl_node_t *key, const avl_ops_t *ops);
+
+/* Largest node that compares below key, or NULL. */
+avl_node_t *avl_predecessor(avl_node_t *root, const avl_node_t *key, const avl_ops_t *ops);
+
+avl_node_t *avl_first(avl_node_t *root);
+avl_node_t *avl_last(avl_node_t *root);
+
+/* Calls visit on every node in ascending order. */
+void avl_walk(avl_node_t *root, void (*visit)(avl_node_t *n, void *arg), void *arg);
+
+#endif				// AVL_H
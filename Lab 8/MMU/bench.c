@@ -0,0 +1,405 @@
+// bench.c
+//
+// Allocation latency of every policy as the number of free blocks grows.
+// For each size the same fragmenting trace is replayed through each policy;
+// only the allocations after the setup phase are timed.
+//
+// A second run replays one long churn trace through first, best and worst
+// fit with deferred and eager coalescing, to compare failed requests and
+// total runtime. A third run replays it with compaction on the
+// COALESCE/COMPACT records and at several fragmentation thresholds, to weigh
+// the requests saved against the bytes copied. Another run compares the
+// bitmap policy at several granularities with the list based policies, and
+// another puts the slab cache in front of first, best and worst fit on a
+// trace where most requests recur in a few sizes. The last one frees blocks
+// among more and more live PIDs, through the PID index of ALLOC_LIST and by
+// the list walk it replaced.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list.h"
+#include "util.h"
+#include "memory.h"
+#include "trace.h"
+
+#define BENCH_REQUESTS 2000
+#define CHURN_PARTITION (1024 * 1024)
+#define CHURN_RECORDS 100000
+#define CHURN_FILL_PERCENT 97
+#define CHURN_COALESCE_EVERY 1000
+#define RECURRING_PERCENT 90
+#define PID_FREES 2000
+#define PID_BLOCKS 4           // blocks per PID for freeing all of them
+
+typedef struct config {
+  char *name;
+  int policy;
+  int flags;
+}config_t;
+
+static config_t configs[] = {
+  { "F", POLICY_FIRSTFIT, 0 },
+  { "B", POLICY_BESTFIT, 0 },
+  { "W", POLICY_WORSTFIT, 0 },
+  { "N", POLICY_NEXTFIT, 0 },
+  { "F-INDEX", POLICY_FIRSTFIT, MEMORY_INDEXED },
+  { "B-INDEX", POLICY_BESTFIT, MEMORY_INDEXED },
+  { "W-INDEX", POLICY_WORSTFIT, MEMORY_INDEXED },
+  { "BUDDY", POLICY_BUDDY, 0 },
+  { "TLSF", POLICY_TLSF, 0 },
+  { "BITMAP", POLICY_BITMAP, 0 },
+};
+
+#define NCONFIGS (int)(sizeof(configs) / sizeof(configs[0]))
+
+double bench_policy(trace_t *t, int setup, config_t *c, int *failures){
+  memory_t *m = memory_alloc(t->partition_size, c->policy, c->flags | MEMORY_QUIET);
+  long long start_ns, alloc_ns = 0;
+  int i, requests = 0;
+
+  for(i = 0; i < t->n; i++){
+    if(t->ops[i][0] > 0){
+      start_ns = now_ns();
+      if(memory_allocate(m, t->ops[i][0], t->ops[i][1]) != 0)
+        *failures += 1;
+      if(i >= setup){
+        alloc_ns += now_ns() - start_ns;
+        requests += 1;
+      }
+    }
+    else
+      memory_deallocate(m, -t->ops[i][0]);
+  }
+
+  memory_free(m);
+  return requests > 0 ? (double)alloc_ns / requests : 0.0;
+}
+
+void bench_coalescing(){
+  static config_t modes[] = {
+    { "deferred", 0, 0 },
+    { "deferred-index", 0, MEMORY_INDEXED },
+    { "eager", 0, MEMORY_EAGER },
+  };
+  static config_t policies[] = {
+    { "F", POLICY_FIRSTFIT, 0 },
+    { "B", POLICY_BESTFIT, 0 },
+    { "W", POLICY_WORSTFIT, 0 },
+  };
+  unsigned int seed = 1;
+  trace_t *t = trace_churn(CHURN_PARTITION, CHURN_RECORDS, CHURN_FILL_PERCENT, CHURN_COALESCE_EVERY, &seed);
+  memory_t *m;
+  long long start_ns, run_ns;
+  int p, i, j, requests = 0;
+
+  for(j = 0; j < t->n; j++)
+    if(t->ops[j][0] > 0)
+      requests += 1;
+
+  printf("\nDeferred vs eager coalescing: %d records (%d allocations, coalesce every %d, up to %d%% requested) on a %d byte partition\n",
+         t->n, requests, CHURN_COALESCE_EVERY, CHURN_FILL_PERCENT, CHURN_PARTITION);
+  printf("%8s%16s%10s%12s%14s\n", "policy", "coalescing", "failed", "fail rate", "runtime (ms)");
+
+  for(p = 0; p < (int)(sizeof(policies) / sizeof(policies[0])); p++){
+    for(i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i++){
+      m = memory_alloc(t->partition_size, policies[p].policy, policies[p].flags | modes[i].flags | MEMORY_QUIET);
+      start_ns = now_ns();
+      for(j = 0; j < t->n; j++){
+        if(t->ops[j][0] == -99999)
+          memory_coalesce(m);
+        else if(t->ops[j][0] > 0)
+          memory_allocate(m, t->ops[j][0], t->ops[j][1]);
+        else
+          memory_deallocate(m, -t->ops[j][0]);
+      }
+      run_ns = now_ns() - start_ns;
+
+      printf("%8s%16s%10d%11.2f%%%14.1f\n", policies[p].name, modes[i].name, m->alloc_failures,
+             100.0 * m->alloc_failures / requests, run_ns / 1000000.0);
+      fflush(stdout);
+      memory_free(m);
+    }
+  }
+
+  trace_free(t);
+}
+
+void bench_compaction(){
+  static struct {
+    char *name;
+    int flags;
+    int threshold;
+  } modes[] = {
+    { "coalesce", 0, 0 },
+    { "compact", MEMORY_COMPACT, 0 },
+    { "auto 50%", 0, 50 },
+    { "auto 25%", 0, 25 },
+  };
+  static config_t policies[] = {
+    { "F-INDEX", POLICY_FIRSTFIT, MEMORY_INDEXED },
+    { "B-INDEX", POLICY_BESTFIT, MEMORY_INDEXED },
+    { "W-INDEX", POLICY_WORSTFIT, MEMORY_INDEXED },
+    { "TLSF", POLICY_TLSF, 0 },
+  };
+  unsigned int seed = 1;
+  trace_t *t = trace_churn(CHURN_PARTITION, CHURN_RECORDS, CHURN_FILL_PERCENT, CHURN_COALESCE_EVERY, &seed);
+  memory_t *m;
+  long long start_ns, run_ns;
+  int p, i, j;
+
+  printf("\nCompaction: same trace, coalescing vs compacting on COALESCE/COMPACT vs compacting above a fragmentation threshold\n");
+  printf("%8s%12s%10s%14s%16s%14s\n", "policy", "mode", "failed", "compactions", "MB moved", "runtime (ms)");
+
+  for(p = 0; p < (int)(sizeof(policies) / sizeof(policies[0])); p++){
+    for(i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i++){
+      m = memory_alloc(t->partition_size, policies[p].policy, policies[p].flags | modes[i].flags | MEMORY_QUIET);
+      m->compact_threshold = modes[i].threshold;
+      start_ns = now_ns();
+      for(j = 0; j < t->n; j++){
+        if(t->ops[j][0] == -99999){
+          if(modes[i].flags & MEMORY_COMPACT)
+            memory_compact(m);
+          else
+            memory_coalesce(m);
+        }
+        else if(t->ops[j][0] > 0)
+          memory_allocate(m, t->ops[j][0], t->ops[j][1]);
+        else
+          memory_deallocate(m, -t->ops[j][0]);
+      }
+      run_ns = now_ns() - start_ns;
+
+      printf("%8s%12s%10d%14d%16.1f%14.1f\n", policies[p].name, modes[i].name, m->alloc_failures,
+             m->compactions, m->bytes_moved / 1048576.0, run_ns / 1000000.0);
+      fflush(stdout);
+      memory_free(m);
+    }
+  }
+
+  trace_free(t);
+}
+
+void bench_bitmap(){
+  static struct {
+    char *name;
+    int policy;
+    int granularity;
+  } policies[] = {
+    { "F", POLICY_FIRSTFIT, 0 },
+    { "B", POLICY_BESTFIT, 0 },
+    { "W", POLICY_WORSTFIT, 0 },
+    { "BITMAP/16", POLICY_BITMAP, 16 },
+    { "BITMAP/64", POLICY_BITMAP, 64 },
+    { "BITMAP/256", POLICY_BITMAP, 256 },
+  };
+  unsigned int seed = 1;
+  trace_t *t = trace_churn(CHURN_PARTITION, CHURN_RECORDS, CHURN_FILL_PERCENT, CHURN_COALESCE_EVERY, &seed);
+  memory_t *m;
+  long long start_ns, run_ns;
+  double frag_sum;
+  int p, j, int_frag_peak;
+
+  printf("\nBitmap vs lists: same trace, external fragmentation averaged over all records\n");
+  printf("%12s%10s%12s%14s%14s%14s\n", "policy", "failed", "search", "avg ext frag", "int frag peak", "runtime (ms)");
+
+  for(p = 0; p < (int)(sizeof(policies) / sizeof(policies[0])); p++){
+    m = memory_alloc_granular(t->partition_size, policies[p].policy, MEMORY_QUIET, policies[p].granularity);
+    frag_sum = 0.0;
+    int_frag_peak = 0;
+    run_ns = 0;
+    for(j = 0; j < t->n; j++){
+      start_ns = now_ns();
+      if(t->ops[j][0] == -99999)
+        memory_coalesce(m);
+      else if(t->ops[j][0] > 0)
+        memory_allocate(m, t->ops[j][0], t->ops[j][1]);
+      else
+        memory_deallocate(m, -t->ops[j][0]);
+      run_ns += now_ns() - start_ns;
+
+      // the metrics are kept out of the runtime
+      frag_sum += memory_external_frag(m);
+      if(memory_internal_frag(m) > int_frag_peak)
+        int_frag_peak = memory_internal_frag(m);
+    }
+
+    printf("%12s%10d%12lld%13.1f%%%14d%14.1f\n", policies[p].name, m->alloc_failures, m->searched,
+           frag_sum / t->n, int_frag_peak, run_ns / 1000000.0);
+    fflush(stdout);
+    memory_free(m);
+  }
+
+  trace_free(t);
+}
+
+/* Redraws RECURRING_PERCENT of the allocation sizes of t from a handful of
+ * common ones, the way most programs allocate a few record types. */
+static void use_recurring_sizes(trace_t *t, unsigned int *seed){
+  static int common[] = { 24, 32, 48, 64, 128, 256, 512 };
+  int j;
+
+  for(j = 0; j < t->n; j++){
+    if(t->ops[j][0] > 0 && rand_r(seed) % 100 < RECURRING_PERCENT)
+      t->ops[j][1] = common[rand_r(seed) % (int)(sizeof(common) / sizeof(common[0]))];
+  }
+}
+
+void bench_slab(){
+  static config_t policies[] = {
+    { "F", POLICY_FIRSTFIT, 0 },
+    { "F-SLAB", POLICY_FIRSTFIT, MEMORY_SLAB },
+    { "B", POLICY_BESTFIT, 0 },
+    { "B-SLAB", POLICY_BESTFIT, MEMORY_SLAB },
+    { "W", POLICY_WORSTFIT, 0 },
+    { "W-SLAB", POLICY_WORSTFIT, MEMORY_SLAB },
+  };
+  unsigned int seed = 1;
+  trace_t *t = trace_churn(CHURN_PARTITION, CHURN_RECORDS, CHURN_FILL_PERCENT, CHURN_COALESCE_EVERY, &seed);
+  memory_t *m;
+  long long start_ns, run_ns;
+  int p, j, requests = 0;
+
+  use_recurring_sizes(t, &seed);
+  for(j = 0; j < t->n; j++)
+    if(t->ops[j][0] > 0)
+      requests += 1;
+
+  printf("\nSlab cache: same trace with %d%% of the requests in 7 sizes\n", RECURRING_PERCENT);
+  printf("%8s%10s%14s%10s%10s%12s%14s\n", "policy", "failed", "search", "hit rate", "slabs", "reclaimed", "runtime (ms)");
+
+  for(p = 0; p < (int)(sizeof(policies) / sizeof(policies[0])); p++){
+    m = memory_alloc(t->partition_size, policies[p].policy, policies[p].flags | MEMORY_QUIET);
+    start_ns = now_ns();
+    for(j = 0; j < t->n; j++){
+      if(t->ops[j][0] == -99999)
+        memory_coalesce(m);
+      else if(t->ops[j][0] > 0)
+        memory_allocate(m, t->ops[j][0], t->ops[j][1]);
+      else
+        memory_deallocate(m, -t->ops[j][0]);
+    }
+    run_ns = now_ns() - start_ns;
+
+    printf("%8s%10d%14lld%9.1f%%%10d%12lld%14.1f\n", policies[p].name, m->alloc_failures, m->searched,
+           m->slab != NULL ? 100.0 * m->slab->hits / requests : 0.0, m->slab != NULL ? m->slab->nslabs : 0,
+           m->slab != NULL ? m->slab->slabs_reclaimed : 0, run_ns / 1000000.0);
+    fflush(stdout);
+    memory_free(m);
+  }
+
+  trace_free(t);
+}
+
+/* Trace that allocates live PIDs of 32 bytes, then frees a random one and
+ * allocates a new one PID_FREES times. */
+static trace_t *trace_many_pids(int live, unsigned int *seed){
+  trace_t *t = trace_alloc(live * 32 * 2);
+  int *pids = malloc(live * sizeof(int));
+  int pid, i, j;
+
+  for(pid = 1; pid <= live; pid++){
+    trace_add(t, pid, 32);
+    pids[pid - 1] = pid;
+  }
+  for(i = 0; i < PID_FREES; i++){
+    j = rand_r(seed) % live;
+    trace_add(t, -pids[j], 0);
+    trace_add(t, pid, 32);
+    pids[j] = pid++;
+  }
+  free(pids);
+  return t;
+}
+
+void bench_pids(){
+  static int lives[] = { 1000, 4000, 16000, 64000 };
+  unsigned int seed = 1;
+  memory_t *m;
+  trace_t *t;
+  long long start_ns, walk_ns, free_ns, all_ns;
+  int i, j, k, pid, live;
+
+  printf("\nFreeing by PID: ALLOC_LIST walk vs PID index, TLSF, %d frees among the live PIDs\n", PID_FREES);
+  printf("%12s%14s%14s%22s\n", "live PIDs", "walk (ns)", "index (ns)", "free all (ns/block)");
+
+  for(i = 0; i < (int)(sizeof(lives) / sizeof(lives[0])); i++){
+    live = lives[i];
+    t = trace_many_pids(live, &seed);
+    m = memory_alloc(t->partition_size, POLICY_TLSF, MEMORY_QUIET);
+    walk_ns = free_ns = 0;
+    for(j = 0; j < t->n; j++){
+      if(t->ops[j][0] > 0){
+        memory_allocate(m, t->ops[j][0], t->ops[j][1]);
+        continue;
+      }
+      // what finding the block cost before the index
+      start_ns = now_ns();
+      list_get_index_of_by_Pid(m->alloc_list, -t->ops[j][0]);
+      walk_ns += now_ns() - start_ns;
+
+      start_ns = now_ns();
+      memory_deallocate(m, -t->ops[j][0]);
+      free_ns += now_ns() - start_ns;
+    }
+    memory_free(m);
+    trace_free(t);
+
+    // every PID holds several blocks, all freed at once
+    m = memory_alloc(live * PID_BLOCKS * 32 * 2, POLICY_TLSF, MEMORY_QUIET);
+    for(pid = 1; pid <= live; pid++)
+      for(k = 0; k < PID_BLOCKS; k++)
+        memory_allocate(m, pid, 32);
+    start_ns = now_ns();
+    for(pid = 1; pid <= live; pid++)
+      memory_deallocate_all(m, pid);
+    all_ns = now_ns() - start_ns;
+    memory_free(m);
+
+    printf("%12d%14.0f%14.0f%22.0f\n", live, (double)walk_ns / PID_FREES, (double)free_ns / PID_FREES,
+           (double)all_ns / (live * PID_BLOCKS));
+    fflush(stdout);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int max_holes = 8192;
+  int holes, i, failures;
+  unsigned int seed;
+  trace_t *t;
+
+  if(argc > 1)
+    max_holes = atoi(argv[1]);
+
+  printf("Average allocation latency (ns) over %d requests\n", BENCH_REQUESTS);
+  printf("%12s", "free blocks");
+  for(i = 0; i < NCONFIGS; i++)
+    printf("%10s", configs[i].name);
+  printf("\n");
+
+  for(holes = 256; holes <= max_holes; holes *= 2){
+    seed = holes;
+    t = trace_fragmenting(holes, BENCH_REQUESTS, &seed);
+    failures = 0;
+
+    printf("%12d", holes);
+    for(i = 0; i < NCONFIGS; i++){
+      printf("%10.0f", bench_policy(t, 3 * holes, &configs[i], &failures));
+      fflush(stdout);
+    }
+    if(failures > 0)
+      printf("   (%d failed requests)", failures);
+    printf("\n");
+
+    trace_free(t);
+  }
+
+  bench_coalescing();
+  bench_compaction();
+  bench_bitmap();
+  bench_slab();
+  bench_pids();
+
+  return 0;
+}
@@ -0,0 +1,312 @@
+// bitmap.c
+//
+// Bitmap allocator. Searches for a run of free units a 64-bit word at a
+// time instead of walking a list of free blocks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "bitmap.h"
+
+#define WORD_BITS     64
+#define ALL_USED      (~(uint64_t)0)
+#define USED(b, u)    (((b)->used[(u) / WORD_BITS] >> ((u) % WORD_BITS)) & 1)
+
+static int units_of(bitmap_t *b, int bytes){
+  return (bytes + b->granularity - 1) / b->granularity;
+}
+
+/* marks count units from unit as used or free, a word at a time */
+static void set_range(bitmap_t *b, int unit, int count, int used){
+  int word, bit, n;
+  uint64_t mask;
+
+  while(count > 0){
+    word = unit / WORD_BITS;
+    bit = unit % WORD_BITS;
+    n = count < WORD_BITS - bit ? count : WORD_BITS - bit;
+    mask = (n == WORD_BITS ? ALL_USED : ((uint64_t)1 << n) - 1) << bit;
+    if(used)
+      b->used[word] |= mask;
+    else
+      b->used[word] &= ~mask;
+    unit += n;
+    count -= n;
+  }
+}
+
+/* units past the end of the partition are never free */
+static void mark_tail(bitmap_t *b){
+  set_range(b, b->units, b->nwords * WORD_BITS - b->units, 1);
+}
+
+static void skip_full_words(bitmap_t *b){
+  while(b->first_free < b->nwords && b->used[b->first_free] == ALL_USED)
+    b->first_free++;
+}
+
+/* Bit i of the result is set when bits i to i+n-1 of free are all set,
+ * for 1 <= n <= 64. Each step doubles the run length that is checked. */
+static uint64_t run_starts(uint64_t free, int n){
+  int len = 1, shift;
+
+  while(len < n && free != 0){
+    shift = len < n - len ? len : n - len;
+    free &= free >> shift;
+    len += shift;
+  }
+  return free;
+}
+
+/* first unit of the lowest run of n free units, -1 if there is none */
+static int find_run(bitmap_t *b, int n, long long *searched){
+  int w, run = 0, start = 0, low;
+  uint64_t word, starts;
+
+  for(w = b->first_free; w < b->nwords; w++){
+    word = b->used[w];
+    *searched += 1;
+
+    if(word == 0){
+      if(run == 0)
+        start = w * WORD_BITS;
+      run += WORD_BITS;
+      if(run >= n)
+        return start;
+      continue;
+    }
+    if(word == ALL_USED){
+      run = 0;
+      continue;
+    }
+
+    // the run coming up from the words below goes on over the low free bits
+    low = __builtin_ctzll(word);
+    if(run == 0)
+      start = w * WORD_BITS;
+    if(run + low >= n)
+      return start;
+
+    // a run inside the word
+    if(n <= WORD_BITS){
+      starts = run_starts(~word, n);
+      if(starts != 0)
+        return w * WORD_BITS + __builtin_ctzll(starts);
+    }
+
+    // the high free bits start a run into the next word
+    run = __builtin_clzll(word);
+    start = (w + 1) * WORD_BITS - run;
+  }
+  return -1;
+}
+
+/* free units from unit upward */
+static int free_from(bitmap_t *b, int unit){
+  int count = 0, bit;
+  uint64_t x;
+
+  while(unit < b->units){
+    bit = unit % WORD_BITS;
+    x = b->used[unit / WORD_BITS] >> bit;
+    if(x != 0)
+      return count + __builtin_ctzll(x);
+    count += WORD_BITS - bit;
+    unit += WORD_BITS - bit;
+  }
+  return count;
+}
+
+/* free units right below unit */
+static int free_below(bitmap_t *b, int unit){
+  int count = 0, bit;
+  uint64_t x;
+
+  while(unit > 0){
+    bit = (unit - 1) % WORD_BITS;
+    x = b->used[(unit - 1) / WORD_BITS] << (WORD_BITS - 1 - bit);
+    if(x != 0)
+      return count + __builtin_clzll(x);
+    count += bit + 1;
+    unit -= bit + 1;
+  }
+  return count;
+}
+
+/* scans for the longest run of free units */
+static void find_largest(bitmap_t *b){
+  int w, pos, low, run = 0, start = 0, unseen = b->free_units;
+  uint64_t word;
+
+  b->largest_start = 0;
+  b->largest_run = 0;
+  for(w = b->first_free; w < b->nwords && b->largest_run < run + unseen; w++){
+    word = b->used[w];
+    unseen -= WORD_BITS - __builtin_popcountll(word);
+    if(word == ALL_USED){
+      run = 0;
+      continue;
+    }
+
+    // alternate between free bits, which extend the run, and used ones
+    pos = 0;
+    while(pos < WORD_BITS){
+      low = word >> pos == 0 ? WORD_BITS - pos : __builtin_ctzll(word >> pos);
+      if(low > 0){
+        if(run == 0)
+          start = w * WORD_BITS + pos;
+        run += low;
+        if(run > b->largest_run){
+          b->largest_run = run;
+          b->largest_start = start;
+        }
+      }
+      if(word >> pos == 0)
+        break;
+      run = 0;
+      pos += low;
+      pos += __builtin_ctzll(~(word >> pos));   // the shifted in zeros end the used bits
+    }
+  }
+  b->largest_valid = 1;
+}
+
+bitmap_t *bitmap_alloc(int size, int granularity){
+  bitmap_t *b = malloc(sizeof(bitmap_t));
+
+  b->size = size;
+  b->granularity = granularity;
+  b->units = size > 0 ? size / granularity : 0;
+  b->nwords = b->units / WORD_BITS + 1;
+  b->used = calloc(b->nwords, sizeof(uint64_t));
+  b->first_free = 0;
+  b->free_units = b->units;
+  b->internal_frag = 0;
+  b->largest_start = 0;
+  b->largest_run = 0;
+  b->largest_valid = 0;
+  mark_tail(b);
+  skip_full_words(b);
+
+  return b;
+}
+
+void bitmap_free(bitmap_t *b){
+  free(b->used);
+  free(b);
+}
+
+int bitmap_allocate(bitmap_t *b, list_t *alloclist, int pid, int blocksize, long long *searched){
+  block_t *allocated_blk;
+  int n, unit;
+
+  if(blocksize <= 0)
+    return -1;
+  n = units_of(b, blocksize);
+  if(n > b->free_units)
+    return -1;
+
+  unit = find_run(b, n, searched);
+  if(unit == -1)
+    return -1;
+
+  set_range(b, unit, n, 1);
+  b->free_units -= n;
+  b->internal_frag += n * b->granularity - blocksize;
+  skip_full_words(b);
+  if(b->largest_valid && unit < b->largest_start + b->largest_run && b->largest_start < unit + n)
+    b->largest_valid = 0;
+
+  allocated_blk = list_block_alloc(alloclist);
+  allocated_blk->pid = pid;
+  allocated_blk->start = unit * b->granularity;
+  allocated_blk->end = allocated_blk->start + blocksize - 1;
+  list_add_ascending_by_address(alloclist, allocated_blk);
+  return 0;
+}
+
+int bitmap_deallocate(bitmap_t *b, list_t *alloclist, int pid){
+  block_t *blk = list_remove_by_pid(alloclist, pid);
+  int unit, size, n, below, above;
+
+  if(blk == NULL)
+    return -1;
+
+  unit = blk->start / b->granularity;
+  size = blk->end - blk->start + 1;
+  n = units_of(b, size);
+  list_block_free(alloclist, blk);
+
+  set_range(b, unit, n, 0);
+  b->free_units += n;
+  b->internal_frag -= n * b->granularity - size;
+  if(unit / WORD_BITS < b->first_free)
+    b->first_free = unit / WORD_BITS;
+
+  // the freed units and their free neighbours are one run now
+  if(b->largest_valid){
+    below = free_below(b, unit);
+    above = free_from(b, unit + n);
+    if(below + n + above > b->largest_run){
+      b->largest_start = unit - below;
+      b->largest_run = below + n + above;
+    }
+  }
+  return 0;
+}
+
+int bitmap_free_bytes(bitmap_t *b){
+  return b->free_units * b->granularity;
+}
+
+int bitmap_largest_free(bitmap_t *b){
+  if(!b->largest_valid)
+    find_largest(b);
+  return b->largest_run * b->granularity;
+}
+
+int bitmap_compact(bitmap_t *b, list_t *alloclist){
+  node_t *current;
+  int unit = 0, start, size, moved = 0;
+
+  for(current = alloclist->head; current != NULL; current = current->next){
+    size = current->blk->end - current->blk->start + 1;
+    start = unit * b->granularity;
+    if(current->blk->start != start){
+      moved += size;
+      current->blk->start = start;
+      current->blk->end = start + size - 1;
+    }
+    unit += units_of(b, size);
+  }
+
+  memset(b->used, 0, b->nwords * sizeof(uint64_t));
+  set_range(b, 0, unit, 1);
+  mark_tail(b);
+  b->free_units = b->units - unit;
+  b->first_free = unit / WORD_BITS;
+  skip_full_words(b);
+  b->largest_valid = 0;
+
+  return moved;
+}
+
+void bitmap_print(bitmap_t *b, char *message){
+  int u = 0, start, i = 0;
+
+  printf("%s:\n", message);
+
+  while(u < b->units){
+    if(USED(b, u)){
+      u++;
+      continue;
+    }
+    start = u;
+    while(u < b->units && !USED(b, u))
+      u++;
+    printf("Block %d:\t START: %d\t END: %d\n", i, start * b->granularity, u * b->granularity - 1);
+    i += 1;
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdint.h>
+
+#include "list.h"
+
+/**
+ * Bitmap allocator for the -BITMAP policy.
+ *
+ * The partition is cut into units of granularity bytes and every unit has
+ * one bit, set while the unit is allocated. A request takes the lowest run
+ * of enough clear bits, found a 64-bit word at a time: whole words are
+ * skipped when full or taken when empty, and inside a mixed word the
+ * candidate runs come out of ctz/clz on the word, so the cost follows the
+ * number of words rather than the number of free blocks. Requests are
+ * rounded up to whole units, which shows up as internal fragmentation. A
+ * tail shorter than one unit is never handed out.
+ */
+
+#define BITMAP_GRANULARITY 64    // default bytes per bit
+
+typedef struct bitmap {
+  int size;                 // partition size in bytes
+  int granularity;          // bytes per bit
+  int units;                // usable units, size / granularity
+  int nwords;
+  uint64_t *used;           // bit set when the unit is allocated, units past the end stay set
+  int first_free;           // no word below this one has a clear bit
+  int free_units;
+  int internal_frag;        // bytes lost to rounding requests up to whole units
+  int largest_start;        // longest run of free units, while largest_valid
+  int largest_run;
+  int largest_valid;        // cleared when an allocation cuts into that run
+}bitmap_t;
+
+bitmap_t *bitmap_alloc(int size, int granularity);
+void bitmap_free(bitmap_t *b);
+
+/* Allocates blocksize bytes for pid at the lowest address with enough free
+ * units and records the block in alloclist, adding the number of words
+ * examined to searched.
+ * Returns 0 on success and -1 when no run of free units is long enough. */
+int bitmap_allocate(bitmap_t *b, list_t *alloclist, int pid, int blocksize, long long *searched);
+
+/* Clears the units held by pid. Returns 0 on success and -1 when pid holds
+ * no memory. */
+int bitmap_deallocate(bitmap_t *b, list_t *alloclist, int pid);
+
+/* Free bytes, and size of the largest run of free units in bytes. The
+ * largest run is cached; frees extend it in place and only an allocation
+ * inside it forces a new scan, which stops once the free units it has not
+ * reached yet, counted with popcount, could not make a longer one. */
+int bitmap_free_bytes(bitmap_t *b);
+int bitmap_largest_free(bitmap_t *b);
+
+/* Moves the blocks of alloclist, which is in address order, down to unit 0
+ * and sets their units again. Returns the number of bytes moved. */
+int bitmap_compact(bitmap_t *b, list_t *alloclist);
+
+/* Prints the runs of free units in ascending address order. */
+void bitmap_print(bitmap_t *b, char *message);
+
+#endif				// BITMAP_H
@@ -0,0 +1,236 @@
+// buddy.c
+//
+// Binary buddy allocator. Blocks are tracked by slot, where a slot is the
+// smallest block size (1 << min_order bytes); the tag of a block's first slot
+// says whether it is free or allocated and at which order.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "buddy.h"
+
+#define SLOT(b, addr)  ((addr) >> (b)->min_order)
+
+static void free_area_push(buddy_t *b, int start, int order){
+  int s = SLOT(b, start);
+  int head = b->free_area[order];
+
+  b->next[s] = head;
+  b->prev[s] = -1;
+  if(head != -1)
+    b->prev[head] = s;
+  b->free_area[order] = s;
+  b->avail |= 1u << order;
+  b->tag[s] = order + 1;
+  b->free_bytes += 1 << order;
+}
+
+static void free_area_remove(buddy_t *b, int start, int order){
+  int s = SLOT(b, start);
+
+  if(b->prev[s] != -1)
+    b->next[b->prev[s]] = b->next[s];
+  else
+    b->free_area[order] = b->next[s];
+  if(b->next[s] != -1)
+    b->prev[b->next[s]] = b->prev[s];
+
+  if(b->free_area[order] == -1)
+    b->avail &= ~(1u << order);
+  b->tag[s] = 0;
+  b->free_bytes -= 1 << order;
+}
+
+static int order_for(buddy_t *b, int blocksize){
+  int order = b->min_order;
+
+  while(order <= b->max_order && (1 << order) < blocksize)
+    order++;
+  return order;
+}
+
+/* Splits [start, size) into aligned power-of-two free blocks, largest first.
+ * Any tail smaller than the minimum block is never handed out. */
+static void carve(buddy_t *b, int start){
+  int order;
+
+  while(start < b->size){
+    for(order = b->max_order; order >= b->min_order; order--){
+      if((start & ((1 << order) - 1)) == 0 && b->size - start >= (1 << order))
+        break;
+    }
+    if(order < b->min_order)
+      break;
+    free_area_push(b, start, order);
+    start += 1 << order;
+  }
+}
+
+buddy_t *buddy_alloc(int size){
+  buddy_t *b = malloc(sizeof(buddy_t));
+  int nslots, order;
+
+  b->size = size;
+  b->min_order = BUDDY_MIN_ORDER;
+  b->max_order = b->min_order;
+  while(b->max_order < BUDDY_MAX_ORDER && (1 << (b->max_order + 1)) <= size)
+    b->max_order++;
+  b->avail = 0;
+  b->internal_frag = 0;
+  b->free_bytes = 0;
+  for(order = 0; order <= BUDDY_MAX_ORDER; order++)
+    b->free_area[order] = -1;
+
+  nslots = (size >> b->min_order) + 1;
+  b->next = malloc(nslots * sizeof(int));
+  b->prev = malloc(nslots * sizeof(int));
+  b->tag = calloc(nslots, sizeof(signed char));
+
+  carve(b, 0);
+
+  return b;
+}
+
+void buddy_free(buddy_t *b){
+  free(b->next);
+  free(b->prev);
+  free(b->tag);
+  free(b);
+}
+
+int buddy_allocate(buddy_t *b, list_t *alloclist, int pid, int blocksize, long long *searched){
+  int order = order_for(b, blocksize);
+  int found, start;
+  unsigned int candidates;
+  block_t *allocated_blk;
+
+  // the avail bitmask answers for every order at once
+  *searched += 1;
+  candidates = order <= b->max_order ? b->avail >> order << order : 0;
+  if(blocksize <= 0 || candidates == 0){
+    return -1;
+  }
+
+  // smallest order that has a free block, then split it down
+  found = __builtin_ctz(candidates);
+  start = b->free_area[found] << b->min_order;
+  free_area_remove(b, start, found);
+  while(found > order){
+    found--;
+    free_area_push(b, start + (1 << found), found);
+  }
+
+  b->tag[SLOT(b, start)] = -(order + 1);
+  b->internal_frag += (1 << order) - blocksize;
+
+  allocated_blk = list_block_alloc(alloclist);
+  allocated_blk->pid = pid;
+  allocated_blk->start = start;
+  allocated_blk->end = start + blocksize - 1;
+  list_add_ascending_by_address(alloclist, allocated_blk);
+  return 0;
+}
+
+int buddy_deallocate(buddy_t *b, list_t *alloclist, int pid){
+  block_t *blk = list_remove_by_pid(alloclist, pid);
+  int order, start, buddy;
+
+  if(blk == NULL)
+    return -1;
+
+  start = blk->start;
+  order = -b->tag[SLOT(b, start)] - 1;
+  b->internal_frag -= (1 << order) - (blk->end - blk->start + 1);
+  list_block_free(alloclist, blk);
+
+  // merge upwards while the buddy is a free block of the same order
+  while(order < b->max_order){
+    buddy = start ^ (1 << order);
+    if(buddy + (1 << order) > b->size || b->tag[SLOT(b, buddy)] != order + 1)
+      break;
+    free_area_remove(b, buddy, order);
+    if(buddy < start)
+      start = buddy;
+    order++;
+  }
+  free_area_push(b, start, order);
+  return 0;
+}
+
+int buddy_largest_free(buddy_t *b){
+  return b->avail != 0 ? 1 << (31 - __builtin_clz(b->avail)) : 0;
+}
+
+int buddy_compact(buddy_t *b, list_t *alloclist){
+  int n = list_length(alloclist);
+  block_t **blocks = malloc((n + 1) * sizeof(block_t *));
+  block_t **sorted = malloc((n + 1) * sizeof(block_t *));
+  int count[BUDDY_MAX_ORDER + 2] = { 0 };
+  int i, order, size, start = 0, moved = 0;
+
+  for(i = 0; i < n; i++){
+    blocks[i] = list_remove_from_front(alloclist);
+    count[-b->tag[SLOT(b, blocks[i]->start)] - 1] += 1;
+  }
+
+  // counting sort by descending order, stable so equal orders keep their
+  // address order; count[k] becomes the first index of order k
+  for(order = BUDDY_MAX_ORDER, i = 0; order >= 0; order--){
+    size = count[order];
+    count[order] = i;
+    i += size;
+  }
+  for(i = 0; i < n; i++){
+    order = -b->tag[SLOT(b, blocks[i]->start)] - 1;
+    sorted[count[order]++] = blocks[i];
+  }
+
+  // forget every block, then lay the allocated ones out from address 0.
+  // Each block's order is no larger than the ones before it, so start is
+  // always a multiple of its size.
+  memset(b->tag, 0, (b->size >> b->min_order) + 1);
+  for(order = 0; order <= BUDDY_MAX_ORDER; order++)
+    b->free_area[order] = -1;
+  b->avail = 0;
+  b->free_bytes = 0;
+
+  for(i = 0; i < n; i++){
+    size = sorted[i]->end - sorted[i]->start + 1;
+    order = order_for(b, size);
+    if(sorted[i]->start != start)
+      moved += size;
+    sorted[i]->start = start;
+    sorted[i]->end = start + size - 1;
+    b->tag[SLOT(b, start)] = -(order + 1);
+    start += 1 << order;
+  }
+  carve(b, start);
+
+  for(i = n - 1; i >= 0; i--)
+    list_add_to_front(alloclist, sorted[i]);
+
+  free(blocks);
+  free(sorted);
+  return moved;
+}
+
+void buddy_print(buddy_t *b, char *message){
+  int s = 0, i = 0;
+  int nslots = (b->size >> b->min_order) + 1;
+  int order;
+
+  printf("%s:\n", message);
+
+  while(s < nslots){
+    if(b->tag[s] > 0){
+      order = b->tag[s] - 1;
+      printf("Block %d:\t START: %d\t END: %d\n", i, s << b->min_order, (s << b->min_order) + (1 << order) - 1);
+      s += 1 << (order - b->min_order);
+      i += 1;
+    }
+    else
+      s++;
+  }
+}
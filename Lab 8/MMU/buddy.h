@@ -0,0 +1,55 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include "list.h"
+
+/**
+ * Binary buddy allocator for the -BUDDY policy.
+ *
+ * The partition is carved into aligned power-of-two blocks. Each order keeps
+ * its own free list, allocation splits a larger block down to the requested
+ * order and freeing merges a block with its buddy right away, so the
+ * COALESCE/COMPACT step has nothing left to do.
+ */
+
+#define BUDDY_MIN_ORDER 4     // smallest block handed out is 16 bytes
+#define BUDDY_MAX_ORDER 30
+
+typedef struct buddy {
+  int size;                   // partition size in bytes
+  int min_order;
+  int max_order;
+  unsigned int avail;         // bit k is set when free_area[k] is not empty
+  int free_area[BUDDY_MAX_ORDER + 1];   // head slot of each order's free list, -1 if empty
+  int *next;                  // free list links, indexed by slot
+  int *prev;
+  signed char *tag;           // order+1 of a free block, -(order+1) of an allocated one, 0 otherwise
+  int internal_frag;          // bytes lost to rounding requests up to a power of two
+  int free_bytes;             // total size of the free blocks
+}buddy_t;
+
+buddy_t *buddy_alloc(int size);
+void buddy_free(buddy_t *b);
+
+/* Allocates blocksize bytes for pid and records the block in alloclist,
+ * adding the number of free lists consulted to searched.
+ * Returns 0 on success and -1 when no block of the needed order is free. */
+int buddy_allocate(buddy_t *b, list_t *alloclist, int pid, int blocksize, long long *searched);
+
+/* Releases the block held by pid and merges it with its free buddies.
+ * Returns 0 on success and -1 when pid holds no memory. */
+int buddy_deallocate(buddy_t *b, list_t *alloclist, int pid);
+
+/* Size of the largest free block, 0 when nothing is free. */
+int buddy_largest_free(buddy_t *b);
+
+/* Moves the allocated blocks to the bottom of the partition, largest order
+ * first so each one stays aligned to its size, and rebuilds the free lists
+ * from the space above them. alloclist is left in address order.
+ * Returns the number of bytes moved. */
+int buddy_compact(buddy_t *b, list_t *alloclist);
+
+/* Prints the free blocks in ascending address order. */
+void buddy_print(buddy_t *b, char *message);
+
+#endif				// BUDDY_H
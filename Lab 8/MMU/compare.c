@@ -0,0 +1,216 @@
+// compare.c
+//
+// Replays one or more traces through every memory policy at once. Each
+// (trace, policy) pair is a job with its own memory_t and its own stream of
+// the trace file, and a pool of threads takes jobs until none are left, so
+// a sweep over many traces keeps every core busy. Results are printed per
+// trace, one row per policy, once all jobs have finished.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "util.h"
+#include "memory.h"
+#include "stats.h"
+
+typedef struct config {
+  char *name;
+  int policy;
+  int flags;
+}config_t;
+
+static config_t configs[] = {
+  { "F", POLICY_FIRSTFIT, 0 },
+  { "B", POLICY_BESTFIT, 0 },
+  { "W", POLICY_WORSTFIT, 0 },
+  { "N", POLICY_NEXTFIT, 0 },
+  { "F-INDEX", POLICY_FIRSTFIT, MEMORY_INDEXED },
+  { "B-INDEX", POLICY_BESTFIT, MEMORY_INDEXED },
+  { "W-INDEX", POLICY_WORSTFIT, MEMORY_INDEXED },
+  { "F-EAGER", POLICY_FIRSTFIT, MEMORY_EAGER },
+  { "B-EAGER", POLICY_BESTFIT, MEMORY_EAGER },
+  { "W-EAGER", POLICY_WORSTFIT, MEMORY_EAGER },
+  { "F-SLAB", POLICY_FIRSTFIT, MEMORY_SLAB },
+  { "B-SLAB", POLICY_BESTFIT, MEMORY_SLAB },
+  { "W-SLAB", POLICY_WORSTFIT, MEMORY_SLAB },
+  { "BUDDY", POLICY_BUDDY, 0 },
+  { "TLSF", POLICY_TLSF, 0 },
+  { "BITMAP", POLICY_BITMAP, 0 },
+};
+
+#define NCONFIGS (int)(sizeof(configs) / sizeof(configs[0]))
+
+typedef struct job {
+  char *trace;
+  config_t *config;
+  int partition_size;
+  memory_t *memory;        // kept until the results are printed
+  stats_t stats;
+}job_t;
+
+typedef struct queue {
+  job_t *jobs;
+  int n;
+  int next;                // first job not taken yet
+  pthread_mutex_t lock;
+}queue_t;
+
+void print_usage(){
+  printf("usage: ./mmu_compare [-{F | B | W | N | F-INDEX | ... | BUDDY | TLSF | BITMAP}]... [-THREADS=<n>] [-CSV] <input file>...\n");
+  printf("  replays every input file through each listed policy, or all of them, in parallel\n");
+}
+
+void run_job(job_t *job){
+  FILE *input = fopen(job->trace, "r");
+  int record[2];
+
+  stats_init(&job->stats);
+  if(input == NULL){
+    job->memory = NULL;
+    return;
+  }
+
+  parse_partition(input, &job->partition_size);
+  job->memory = memory_alloc(job->partition_size, job->config->policy, job->config->flags | MEMORY_QUIET);
+  while(parse_record(input, record))
+    stats_apply(&job->stats, job->memory, record, 0);
+
+  fclose(input);
+}
+
+void *worker(void *arg){
+  queue_t *queue = arg;
+  int i;
+
+  for(;;){
+    pthread_mutex_lock(&queue->lock);
+    i = queue->next < queue->n ? queue->next++ : -1;
+    pthread_mutex_unlock(&queue->lock);
+
+    if(i == -1)
+      return NULL;
+    run_job(&queue->jobs[i]);
+  }
+}
+
+void print_table(job_t *jobs, int n){
+  stats_t *s;
+  memory_t *m;
+  int i;
+
+  printf("\n%s: %lld records, partition %d bytes\n", jobs[0].trace, jobs[0].stats.records, jobs[0].partition_size);
+  printf("%10s%12s%10s%10s%11s%11s%14s%12s\n", "policy", "ops/sec", "failed", "search",
+         "peak frag", "avg frag", "avg largest", "int frag");
+
+  for(i = 0; i < n; i++){
+    s = &jobs[i].stats;
+    m = jobs[i].memory;
+    printf("%10s%12.0f%10d%10.2f%10.1f%%%10.1f%%%14.0f%12d\n", jobs[i].config->name,
+           s->sim_ns > 0 ? s->records * 1e9 / s->sim_ns : 0.0, m->alloc_failures,
+           s->requests > 0 ? (double)m->searched / s->requests : 0.0, s->frag_peak,
+           s->records > 0 ? s->frag_sum / s->records : 0.0,
+           s->records > 0 ? (double)s->largest_sum / s->records : 0.0, s->internal_frag_peak);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int selected[NCONFIGS], nselected = 0, ntraces = 0, nthreads = 0, csv = 0;
+  char chosen[NCONFIGS] = { 0 };
+  char **traces = malloc(argc * sizeof(char *));
+  pthread_t *threads;
+  queue_t queue;
+  int i, j, k;
+
+  for(i = 1; i < argc; i++){
+    if(argv[i][0] != '-'){
+      traces[ntraces++] = argv[i];
+      continue;
+    }
+    for(j = 0; argv[i][j] != '\0'; j++)
+      argv[i][j] = toupper(argv[i][j]);
+
+    if(strcmp(argv[i], "-CSV") == 0)
+      csv = 1;
+    else if(sscanf(argv[i], "-THREADS=%d", &nthreads) == 1 && nthreads > 0)
+      continue;
+    else {
+      for(j = 0; j < NCONFIGS && strcmp(argv[i] + 1, configs[j].name) != 0; j++)
+        ;
+      if(j == NCONFIGS){
+        print_usage();
+        exit(1);
+      }
+      // a policy given twice runs once, so there are never more than NCONFIGS
+      if(!chosen[j])
+        selected[nselected++] = j;
+      chosen[j] = 1;
+    }
+  }
+
+  if(ntraces == 0){
+    print_usage();
+    exit(1);
+  }
+  if(nselected == 0){
+    for(j = 0; j < NCONFIGS; j++)
+      selected[nselected++] = j;
+  }
+
+  // jobs of one trace are next to each other, in the order given
+  queue.n = ntraces * nselected;
+  queue.next = 0;
+  queue.jobs = calloc(queue.n, sizeof(job_t));
+  pthread_mutex_init(&queue.lock, NULL);
+  for(i = 0; i < ntraces; i++){
+    for(j = 0; j < nselected; j++){
+      queue.jobs[i * nselected + j].trace = traces[i];
+      queue.jobs[i * nselected + j].config = &configs[selected[j]];
+    }
+  }
+
+  if(nthreads == 0)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if(nthreads > queue.n)
+    nthreads = queue.n;
+  threads = malloc(nthreads * sizeof(pthread_t));
+  for(k = 0; k < nthreads; k++)
+    pthread_create(&threads[k], NULL, worker, &queue);
+  for(k = 0; k < nthreads; k++)
+    pthread_join(threads[k], NULL);
+
+  if(csv){
+    printf("trace,");
+    stats_print_csv_header();
+  }
+  for(i = 0; i < ntraces; i++){
+    if(queue.jobs[i * nselected].memory == NULL){
+      fprintf(stderr, "Error: Invalid filepath %s\n", traces[i]);
+      continue;
+    }
+    if(!csv){
+      print_table(&queue.jobs[i * nselected], nselected);
+      continue;
+    }
+    for(j = 0; j < nselected; j++){
+      printf("%s,", traces[i]);
+      stats_print_csv(&queue.jobs[i * nselected + j].stats, queue.jobs[i * nselected + j].memory,
+                      queue.jobs[i * nselected + j].config->name);
+    }
+  }
+
+  for(i = 0; i < queue.n; i++){
+    if(queue.jobs[i].memory != NULL)
+      memory_free(queue.jobs[i].memory);
+  }
+  pthread_mutex_destroy(&queue.lock);
+  free(queue.jobs);
+  free(threads);
+  free(traces);
+
+  return 0;
+}
@@ -0,0 +1,384 @@
+// freetree.c
+//
+// Free space of first, best and worst fit indexed by AVL trees, so that
+// finding a block and returning one are O(log n) instead of a list walk.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "list.h"
+#include "avl.h"
+#include "memory.h"
+#include "freetree.h"
+
+#define LABEL_GAP        (1LL << 20)
+#define POOL_CHUNK       512
+
+#define BLOCKSIZE(b)     ((b)->blk.end - (b)->blk.start + 1)
+#define BY_POS(n)        AVL_ENTRY(n, free_block_t, by_pos)
+#define BY_SIZE(n)       AVL_ENTRY(n, free_block_t, by_size)
+#define BY_ADDR(n)       AVL_ENTRY(n, free_block_t, by_addr)
+
+static int compare(long long x, long long y){
+  return (x > y) - (x < y);
+}
+
+static int cmp_pos(const avl_node_t *a, const avl_node_t *b){
+  return compare(BY_POS(a)->label, BY_POS(b)->label);
+}
+
+static int cmp_ascending(const avl_node_t *a, const avl_node_t *b){
+  free_block_t *x = BY_SIZE(a), *y = BY_SIZE(b);
+
+  if(BLOCKSIZE(x) != BLOCKSIZE(y))
+    return compare(BLOCKSIZE(x), BLOCKSIZE(y));
+  return compare(x->label, y->label);
+}
+
+static int cmp_descending(const avl_node_t *a, const avl_node_t *b){
+  free_block_t *x = BY_SIZE(a), *y = BY_SIZE(b);
+
+  if(BLOCKSIZE(x) != BLOCKSIZE(y))
+    return compare(BLOCKSIZE(y), BLOCKSIZE(x));
+  return compare(x->label, y->label);
+}
+
+static int cmp_addr(const avl_node_t *a, const avl_node_t *b){
+  return compare(BY_ADDR(a)->blk.start, BY_ADDR(b)->blk.start);
+}
+
+static int value_size(const avl_node_t *n){
+  return BLOCKSIZE(BY_POS(n));
+}
+
+static const avl_ops_t pos_ops = { cmp_pos, value_size };
+static const avl_ops_t ascending_ops = { cmp_ascending, NULL };
+static const avl_ops_t descending_ops = { cmp_descending, NULL };
+static const avl_ops_t addr_ops = { cmp_addr, NULL };
+
+static void relabel(avl_node_t *n, void *arg){
+  long long *label = arg;
+
+  *label += LABEL_GAP;
+  BY_POS(n)->label = *label;
+}
+
+/* First node in list order whose size is above (or below) blocksize, that
+ * is the node a sorted list insert stops at. */
+static avl_node_t *first_larger(avl_node_t *n, int blocksize){
+  while(n != NULL){
+    if(n->left != NULL && n->left->max > blocksize)
+      n = n->left;
+    else if(value_size(n) > blocksize)
+      return n;
+    else if(n->right != NULL && n->right->max > blocksize)
+      n = n->right;
+    else
+      return NULL;
+  }
+  return NULL;
+}
+
+static avl_node_t *first_smaller(avl_node_t *n, int blocksize){
+  while(n != NULL){
+    if(n->left != NULL && n->left->min < blocksize)
+      n = n->left;
+    else if(value_size(n) < blocksize)
+      return n;
+    else if(n->right != NULL && n->right->min < blocksize)
+      n = n->right;
+    else
+      return NULL;
+  }
+  return NULL;
+}
+
+/* Gives b the label of the place the policy's FREE_LIST insert would put it. */
+static void place_block(freetree_t *t, free_block_t *b){
+  avl_node_t *next = NULL, *prev;
+  long long before, after, label;
+
+  if(t->policy == POLICY_BESTFIT)           // list_add_ascending_by_blocksize
+    next = first_larger(t->pos_root, BLOCKSIZE(b));
+  else if(t->policy == POLICY_WORSTFIT)     // list_add_descending_by_blocksize
+    next = first_smaller(t->pos_root, BLOCKSIZE(b));
+                                            // list_add_to_back otherwise
+
+  if(next == NULL){
+    prev = avl_last(t->pos_root);
+    b->label = prev != NULL ? BY_POS(prev)->label + LABEL_GAP : 0;
+    return;
+  }
+
+  prev = avl_predecessor(t->pos_root, next, &pos_ops);
+  after = BY_POS(next)->label;
+  before = prev != NULL ? BY_POS(prev)->label : after - 2 * LABEL_GAP;
+  if(after - before < 2){
+    // out of room between the neighbours, spread all labels out again
+    label = 0;
+    avl_walk(t->pos_root, relabel, &label);
+    after = BY_POS(next)->label;
+    before = prev != NULL ? BY_POS(prev)->label : after - 2 * LABEL_GAP;
+  }
+  b->label = before + (after - before) / 2;
+}
+
+static void index_insert(freetree_t *t, free_block_t *b){
+  t->pos_root = avl_insert(t->pos_root, &b->by_pos, &pos_ops);
+  if(t->size_ops != NULL)
+    t->size_root = avl_insert(t->size_root, &b->by_size, t->size_ops);
+  t->addr_root = avl_insert(t->addr_root, &b->by_addr, &addr_ops);
+  t->count += 1;
+  t->free_bytes += BLOCKSIZE(b);
+}
+
+static void index_remove(freetree_t *t, free_block_t *b){
+  t->pos_root = avl_remove(t->pos_root, &b->by_pos, &pos_ops);
+  if(t->size_ops != NULL)
+    t->size_root = avl_remove(t->size_root, &b->by_size, t->size_ops);
+  t->addr_root = avl_remove(t->addr_root, &b->by_addr, &addr_ops);
+  t->count -= 1;
+  t->free_bytes -= BLOCKSIZE(b);
+}
+
+static free_block_t *select_block(freetree_t *t, int blocksize, long long *searched){
+  avl_node_t *n = t->pos_root;
+  free_block_t probe = { .label = LLONG_MIN };
+
+  if(t->policy == POLICY_FIRSTFIT){
+    // first block in list order that fits
+    while(n != NULL){
+      *searched += 1;
+      if(n->left != NULL && n->left->max >= blocksize)
+        n = n->left;
+      else if(value_size(n) >= blocksize)
+        return BY_POS(n);
+      else if(n->right != NULL && n->right->max >= blocksize)
+        n = n->right;
+      else
+        return NULL;
+    }
+    return NULL;
+  }
+
+  // best and worst fit follow one root to leaf path of the size tree
+  if(t->size_root != NULL)
+    *searched += t->size_root->height;
+
+  if(t->policy == POLICY_BESTFIT){
+    // smallest block of at least blocksize bytes, earliest in the list
+    probe.blk.end = blocksize - 1;
+    n = avl_lower_bound(t->size_root, &probe.by_size, t->size_ops);
+    return n != NULL ? BY_SIZE(n) : NULL;
+  }
+
+  // worst fit: largest block, earliest in the list
+  n = avl_first(t->size_root);
+  return n != NULL && BLOCKSIZE(BY_SIZE(n)) >= blocksize ? BY_SIZE(n) : NULL;
+}
+
+freetree_t *freetree_alloc(int size, int policy, int eager){
+  freetree_t *t = malloc(sizeof(freetree_t));
+  free_block_t *b;
+
+  t->policy = policy;
+  if(policy == POLICY_BESTFIT)
+    t->size_ops = &ascending_ops;
+  else if(policy == POLICY_WORSTFIT)
+    t->size_ops = &descending_ops;
+  else
+    t->size_ops = NULL;
+  t->pos_root = NULL;
+  t->size_root = NULL;
+  t->addr_root = NULL;
+  t->count = 0;
+  t->free_bytes = 0;
+  t->size = size;
+  t->eager = eager;
+  t->blocks = pool_alloc(sizeof(free_block_t), POOL_CHUNK);
+
+  if(size > 0){
+    b = pool_get(t->blocks);
+    b->blk.pid = 0;
+    b->blk.start = 0;
+    b->blk.end = size - 1;
+    b->label = 0;
+    index_insert(t, b);
+  }
+
+  return t;
+}
+
+static void collect(avl_node_t *n, void *arg){
+  free_block_t ***next = arg;
+
+  **next = BY_ADDR(n);
+  *next += 1;
+}
+
+/* fills blocks with every free block in ascending address order */
+static void collect_by_address(freetree_t *t, free_block_t **blocks){
+  free_block_t **next = blocks;
+
+  avl_walk(t->addr_root, collect, &next);
+}
+
+void freetree_free(freetree_t *t){
+  pool_free(t->blocks);
+  free(t);
+}
+
+int freetree_allocate(freetree_t *t, list_t *alloclist, int pid, int blocksize, long long *searched){
+  free_block_t *b = blocksize > 0 ? select_block(t, blocksize, searched) : NULL;
+  block_t *allocated_blk;
+
+  if(b == NULL){
+    return -1;
+  }
+
+  index_remove(t, b);
+
+  allocated_blk = list_block_alloc(alloclist);
+  allocated_blk->pid = pid;
+  allocated_blk->start = b->blk.start;
+  allocated_blk->end = b->blk.start + blocksize - 1;
+  list_add_ascending_by_address(alloclist, allocated_blk);
+
+  // the remainder goes back in as a new fragment, like in allocate_memory
+  if(BLOCKSIZE(b) > blocksize){
+    b->blk.start += blocksize;
+    place_block(t, b);
+    index_insert(t, b);
+  }
+  else
+    pool_put(t->blocks, b);
+
+  return 0;
+}
+
+/* Absorbs the free blocks right before and after b, which is not indexed
+ * yet. Both are found in the address tree, so this is O(log n). */
+static free_block_t *merge_neighbours(freetree_t *t, free_block_t *b){
+  avl_node_t *n;
+  free_block_t *neighbour;
+
+  n = avl_predecessor(t->addr_root, &b->by_addr, &addr_ops);
+  if(n != NULL && BY_ADDR(n)->blk.end + 1 == b->blk.start){
+    neighbour = BY_ADDR(n);
+    index_remove(t, neighbour);
+    neighbour->blk.end = b->blk.end;
+    pool_put(t->blocks, b);
+    b = neighbour;
+  }
+
+  n = avl_lower_bound(t->addr_root, &b->by_addr, &addr_ops);
+  if(n != NULL && b->blk.end + 1 == BY_ADDR(n)->blk.start){
+    neighbour = BY_ADDR(n);
+    index_remove(t, neighbour);
+    b->blk.end = neighbour->blk.end;
+    pool_put(t->blocks, neighbour);
+  }
+
+  return b;
+}
+
+int freetree_deallocate(freetree_t *t, list_t *alloclist, int pid){
+  block_t *blk = list_remove_by_pid(alloclist, pid);
+  free_block_t *b;
+
+  if(blk == NULL)
+    return -1;
+
+  b = pool_get(t->blocks);
+  b->blk.pid = 0;
+  b->blk.start = blk->start;
+  b->blk.end = blk->end;
+  list_block_free(alloclist, blk);
+
+  if(t->eager)
+    b = merge_neighbours(t, b);
+  place_block(t, b);
+  index_insert(t, b);
+  return 0;
+}
+
+void freetree_coalesce(freetree_t *t){
+  free_block_t **blocks = malloc((t->count + 1) * sizeof(free_block_t *));
+  int i, n = t->count;
+  long long label = 0;
+  free_block_t *run = NULL;
+
+  collect_by_address(t, blocks);
+
+  // rebuild the trees with the merged blocks labelled in address order
+  t->pos_root = NULL;
+  t->size_root = NULL;
+  t->addr_root = NULL;
+  t->count = 0;
+  t->free_bytes = 0;
+
+  for(i = 0; i <= n; i++){
+    if(i < n && run != NULL && run->blk.end + 1 == blocks[i]->blk.start){  // physically adjacent
+      run->blk.end = blocks[i]->blk.end;
+      pool_put(t->blocks, blocks[i]);
+      continue;
+    }
+    if(run != NULL){
+      run->label = label;
+      label += LABEL_GAP;
+      index_insert(t, run);
+    }
+    run = i < n ? blocks[i] : NULL;
+  }
+
+  free(blocks);
+}
+
+int freetree_largest_free(freetree_t *t){
+  return t->pos_root != NULL ? t->pos_root->max : 0;
+}
+
+int freetree_compact(freetree_t *t, list_t *alloclist){
+  free_block_t **blocks = malloc((t->count + 1) * sizeof(free_block_t *));
+  free_block_t *b;
+  int i, start, moved = 0;
+
+  collect_by_address(t, blocks);
+  for(i = 0; i < t->count; i++)
+    pool_put(t->blocks, blocks[i]);
+  free(blocks);
+
+  t->pos_root = NULL;
+  t->size_root = NULL;
+  t->addr_root = NULL;
+  t->count = 0;
+  t->free_bytes = 0;
+
+  start = compact_allocated(alloclist, &moved);
+  if(start < t->size){
+    b = pool_get(t->blocks);
+    b->blk.pid = 0;
+    b->blk.start = start;
+    b->blk.end = t->size - 1;
+    b->label = 0;
+    index_insert(t, b);
+  }
+
+  return moved;
+}
+
+static void print_block(avl_node_t *n, void *arg){
+  int *i = arg;
+  free_block_t *b = BY_POS(n);
+
+  printf("Block %d:\t START: %d\t END: %d\n", *i, b->blk.start, b->blk.end);
+  *i += 1;
+}
+
+void freetree_print(freetree_t *t, char *message){
+  int i = 0;
+
+  printf("%s:\n", message);
+  avl_walk(t->pos_root, print_block, &i);
+}
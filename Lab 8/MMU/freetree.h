@@ -0,0 +1,68 @@
+#ifndef FREETREE_H
+#define FREETREE_H
+
+#include "list.h"
+#include "avl.h"
+
+/**
+ * Tree indexed free space for first, best and worst fit (the -INDEX option).
+ *
+ * Each free block carries a label that reproduces its position in the
+ * policy's FREE_LIST, so decisions and printed output are the same as with
+ * the list. Three AVL trees index the blocks:
+ *   - by list position, keeping the largest and smallest size per subtree,
+ *     which finds a sorted insert position and the first fit;
+ *   - by size, then list position, which finds the best and worst fit;
+ *   - by address, which drives coalescing.
+ */
+
+typedef struct free_block {
+  block_t blk;             // pid is always zero
+  long long label;         // increases along FREE_LIST
+  avl_node_t by_pos;
+  avl_node_t by_size;
+  avl_node_t by_addr;
+}free_block_t;
+
+typedef struct freetree {
+  int policy;
+  const avl_ops_t *size_ops;   // ascending for best fit, descending for worst fit
+  avl_node_t *pos_root;
+  avl_node_t *size_root;   // unused by first fit
+  avl_node_t *addr_root;
+  int count;               // number of free blocks
+  int free_bytes;          // total size of the free blocks
+  int size;                // partition size in bytes
+  int eager;               // coalesce on every free instead of on request
+  pool_t *blocks;          // every free_block_t
+}freetree_t;
+
+freetree_t *freetree_alloc(int size, int policy, int eager);
+void freetree_free(freetree_t *t);
+
+/* Allocates blocksize bytes for pid and records the block in alloclist,
+ * adding the number of tree nodes visited to searched.
+ * Returns 0 on success and -1 when no free block is large enough. */
+int freetree_allocate(freetree_t *t, list_t *alloclist, int pid, int blocksize, long long *searched);
+
+/* Releases the block held by pid back into the free space, merging it with
+ * its free address neighbours right away when the tree is eager.
+ * Returns 0 on success and -1 when pid holds no memory. */
+int freetree_deallocate(freetree_t *t, list_t *alloclist, int pid);
+
+/* Merges physically adjacent free blocks and leaves them in address order,
+ * as coalese_memory does. */
+void freetree_coalesce(freetree_t *t);
+
+/* Size of the largest free block, 0 when nothing is free. */
+int freetree_largest_free(freetree_t *t);
+
+/* Moves the blocks of alloclist down to address 0 and replaces the free
+ * space with one block above them, as compact_memory does.
+ * Returns the number of bytes moved. */
+int freetree_compact(freetree_t *t, list_t *alloclist);
+
+/* Prints the free blocks in FREE_LIST order. */
+void freetree_print(freetree_t *t, char *message);
+
+#endif				// FREETREE_H
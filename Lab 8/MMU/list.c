@@ -9,19 +9,37 @@
 #include "list.h"
 
 list_t *list_alloc() { 
+  return list_alloc_pooled(NULL, NULL);
+}
+
+list_t *list_alloc_pooled(pool_t *node_pool, pool_t *block_pool) {
   list_t* list = (list_t*)malloc(sizeof(list_t));
   list->head = NULL;
-  return list; 
+  list->node_pool = node_pool;
+  list->block_pool = block_pool;
+  list->index = NULL;
+  return list;
+}
+
+void list_index_by_pid(list_t *l){
+  node_t *current;
+
+  l->index = pidmap_alloc();
+  for(current = l->head; current != NULL; current = current->next)
+    pidmap_add(l->index, current->blk->pid, current);
 }
 
 node_t *node_alloc(block_t *blk) {   
   node_t* node = malloc(sizeof(node_t));
   node->next = NULL;
+  node->prev = NULL;
   node->blk = blk;
   return node; 
 }
 
 void list_free(list_t *l){
+  if(l->index != NULL)
+    pidmap_free(l->index);
   free(l);
   return;
 }
@@ -31,6 +49,67 @@ void node_free(node_t *node){
   return;
 }
 
+static node_t *list_node_alloc(list_t *l, block_t *blk) {
+  node_t *node;
+
+  if(l->node_pool == NULL)
+    return node_alloc(blk);
+  node = pool_get(l->node_pool);
+  node->next = NULL;
+  node->prev = NULL;
+  node->blk = blk;
+  return node;
+}
+
+/* links node in after prev, at the head when prev is NULL */
+static void link_after(list_t *l, node_t *prev, node_t *node){
+  node->prev = prev;
+  if(prev == NULL){
+    node->next = l->head;
+    l->head = node;
+  }
+  else{
+    node->next = prev->next;
+    prev->next = node;
+  }
+  if(node->next != NULL)
+    node->next->prev = node;
+  if(l->index != NULL)
+    pidmap_add(l->index, node->blk->pid, node);
+}
+
+/* unlinks node, which follows prev, without freeing it */
+static void unlink_after(list_t *l, node_t *prev, node_t *node){
+  if(prev == NULL)
+    l->head = node->next;
+  else
+    prev->next = node->next;
+  if(node->next != NULL)
+    node->next->prev = prev;
+  if(l->index != NULL)
+    pidmap_remove(l->index, node->blk->pid, node);
+}
+
+void list_node_free(list_t *l, node_t *node){
+  if(l->node_pool == NULL)
+    node_free(node);
+  else
+    pool_put(l->node_pool, node);
+}
+
+block_t *list_block_alloc(list_t *l){
+  if(l->block_pool == NULL)
+    return malloc(sizeof(block_t));
+  return pool_get(l->block_pool);
+}
+
+void list_block_free(list_t *l, block_t *blk){
+  if(l->block_pool == NULL)
+    free(blk);
+  else
+    pool_put(l->block_pool, blk);
+}
+
 void list_print(list_t *l) {
   node_t *current = l->head;
   block_t *b;
@@ -57,83 +136,91 @@ int list_length(list_t *l) {
 }
 
 void list_add_to_back(list_t *l, block_t *blk){  
-  node_t* newNode = node_alloc(blk);
-  newNode->next = NULL;
+  node_t* newNode = list_node_alloc(l, blk);
   if(l->head == NULL){
-    l->head = newNode;
+    link_after(l, NULL, newNode);
   }
   else{
     node_t *current = l->head;
     while(current->next != NULL){
       current = current->next;
     }
-    current->next = newNode;
+    link_after(l, current, newNode);
   }
 }
 
 void list_add_to_front(list_t *l, block_t *blk){  
-  node_t* newNode = node_alloc(blk);
+  node_t* newNode = list_node_alloc(l, blk);
  
-  newNode->next = l->head;
-  l->head = newNode;
+  link_after(l, NULL, newNode);
 }
 
 void list_add_at_index(list_t *l, block_t *blk, int index){
   int i = 0;
   
-  node_t *newNode = node_alloc(blk);
+  node_t *newNode = list_node_alloc(l, blk);
   node_t *current = l->head;
 
   if(index == 0){
-    newNode->next = l->head->next;
-    l->head = newNode;
+    link_after(l, NULL, newNode);
   }
   else if(index > 0){
     while(i < index && current->next != NULL){
       current = current->next;
       i++;
     }
-  newNode->next = current->next;
-  current->next = newNode;
+  link_after(l, current, newNode);
   }
 }
 
 void list_add_ascending_by_address(list_t *l, block_t *newblk){
-  
-   /*
-   * 1. Insert newblk into list l in ascending order based on the START address of the block.
-   * 
-   *    node_t *c = l.head;
-   *    Insert newblk After Current Node if:   newblk->start > c->start
-   */
+  node_t *current;
+  node_t *prev;
+  node_t *newNode = list_node_alloc(l, newblk);
+
+  if(l->head == NULL || newblk->start < l->head->blk->start){  // new head
+    link_after(l, NULL, newNode);
+  }
+  else{
+    prev = current = l->head;
+
+    while(current != NULL && newblk->start > current->blk->start){
+      prev = current;
+      current = current->next;
+    }
+    link_after(l, prev, newNode);
+  }
 }
 
 void list_add_ascending_by_blocksize(list_t *l, block_t *newblk){
-   /*
-   * 1. Insert newblk into list l in ascending order based on the blocksize.
-   *    blocksize is calculated :  blocksize = end - start +1
-   * 
-   *    Ex:  blocksize = newblk->end - newblk->start
-   * 
-   *         node_t *c = l.head;
-   * 
-   *         curr_blocksize = c->blk->end - c->blk->start +1;
-   * 
-   *         Insert newblk After Current Node if:   blocksize >= curr_blocksize
-   * 
-   *    USE the compareSize()
-   */
+  node_t *current;
+  node_t *prev;
+  node_t *newNode = list_node_alloc(l, newblk);
+  int newblk_size = newblk->end - newblk->start + 1;
+
+  if(l->head == NULL || newblk_size < l->head->blk->end - l->head->blk->start + 1){  // new head
+    link_after(l, NULL, newNode);
+  }
+  else{
+    prev = current = l->head;
+
+    while(current != NULL && newblk_size >= current->blk->end - current->blk->start + 1){
+      prev = current;
+      current = current->next;
+    }
+    link_after(l, prev, newNode);
+  }
 }
 
 void list_add_descending_by_blocksize(list_t *l, block_t *blk){
   node_t *current;
   node_t *prev;
-  node_t *newNode = node_alloc(blk);
+  node_t *newNode = list_node_alloc(l, blk);
   int newblk_size = blk->end - blk->start;
   int curblk_size;
   
   if(l->head == NULL){
-    l->head = newNode;
+    link_after(l, NULL, newNode);
   }
   else{
     prev = current = l->head;
@@ -142,19 +229,16 @@ void list_add_descending_by_blocksize(list_t *l, block_t *blk){
     
     if(current->next == NULL) {  //only one node in list
        if(newblk_size >= curblk_size) {  // place in front of current node
-          newNode->next = l->head;
-          l->head = newNode;
+          link_after(l, NULL, newNode);
        }
        else {   // place behind current node
-          current->next = newNode;
-          newNode->next = NULL;
+          link_after(l, current, newNode);
        }
     }
     else {  // two or more nodes in list
       
        if(newblk_size >= curblk_size) {  // place in front of current node
-          newNode->next = l->head;
-          l->head = newNode;
+          link_after(l, NULL, newNode);
        }
        else {
       
@@ -165,28 +249,33 @@ void list_add_descending_by_blocksize(list_t *l, block_t *blk){
                if(current != NULL)  // the last one in the list
                      curblk_size = current->blk->end - current->blk->start;
           }
-          prev->next = newNode;
-          newNode->next = current;
+          link_after(l, prev, newNode);
        }
     }
   }
 }
 
 void list_coalese_nodes(list_t *l){ 
-  /*
-   * 1. Assuming you have passed in a sorted list of blocks based on addresses in ascending order
-   * 2. While list is not empty,
-   *    a. compare two nodes at a time to see if the prev.END + 1 == current.START, if so, they are physically adjacent
-   *    combine them by setting the prev.END = current.END. 
-   *    b. If not adjacent go to #6
-   * 3. point the prev.NEXT to the current.NEXT to skip over current.
-   * 4. Free current
-   * 5. go back to #2
-   * 6. Advance prev = current, and current = current.NEXT
-   * 7. go back to #2
-   * 
-   * USE the compareSize()
-   */
+  node_t *prev = l->head;
+  node_t *current;
+
+  if(prev == NULL)
+    return;
+
+  current = prev->next;
+  while(current != NULL){
+    if(prev->blk->end + 1 == current->blk->start){  // physically adjacent
+      prev->blk->end = current->blk->end;
+      unlink_after(l, prev, current);
+      list_block_free(l, current->blk);
+      list_node_free(l, current);
+      current = prev->next;
+    }
+    else{
+      prev = current;
+      current = current->next;
+    }
+  }
 }
 
 block_t* list_remove_from_back(list_t *l){
@@ -196,17 +285,18 @@ block_t* list_remove_from_back(list_t *l){
   if(l->head != NULL){
     
     if(current->next == NULL) { // one node
-         l->head->next = NULL;
          value = current->blk;
-         node_free(current);
+         unlink_after(l, NULL, current);
+         list_node_free(l, current);
     }
     else {
          while (current->next->next != NULL){
             current = current->next;
          }
-         value = current->blk;
-         node_free(current->next);
-         current->next = NULL;
+         value = current->next->blk;
+         node_t *last = current->next;
+         unlink_after(l, current, last);
+         list_node_free(l, last);
     }
   }
   return value;
@@ -233,8 +323,8 @@ block_t* list_remove_from_front(list_t *l) {
   else{
     node_t *current = l->head;
     value = current->blk;
-    l->head = l->head->next;
-    node_free(current);
+    unlink_after(l, NULL, current);
+    list_node_free(l, current);
   }
   return value; 
 }
@@ -268,13 +358,38 @@ block_t* list_remove_at_index(list_t *l, int index) {
     
     if(found) {
       value = current->blk; 
-      prev->next = current->next;
-      node_free(current);
+      unlink_after(l, prev, current);
+      list_node_free(l, current);
     }
   }
   return value; 
 }
 
+block_t* list_remove_by_pid(list_t *l, int pid) {
+  node_t *current, *prev = NULL;
+  block_t *value;
+
+  if(l->index != NULL){
+    current = pidmap_find(l->index, pid);
+    if(current != NULL)
+      prev = current->prev;
+  }
+  else{
+    current = l->head;
+    while(current != NULL && current->blk->pid != pid){
+      prev = current;
+      current = current->next;
+    }
+  }
+
+  if(current == NULL)
+    return NULL;
+  value = current->blk;
+  unlink_after(l, prev, current);
+  list_node_free(l, current);
+  return value;
+}
+
 bool compareBlks(block_t* a, block_t *b) {
   
   if(a->pid == b->pid && a->start == b->start && a->end == b->end)
@@ -367,12 +482,16 @@ return false;
 
 /* Checks to see if pid of block exists in the list. */
 bool list_is_in_by_pid(list_t *l, int pid){ 
-  
-  /* Iterate through the list to find a node with a blk that has blk->pid = pid
-   * 
-   * USE the comparePID()
-   * 
-   * Look at list_is_in_by_size()
+  node_t *current = l->head;
+  if(l->index != NULL)
+    return pidmap_find(l->index, pid) != NULL;
+  while(current != NULL){
+    if(comparePid(pid, current->blk)){
+      return true;
+    }
+    current = current->next;
+  }
+return false; 
 }
 
 /* Returns the index at which the given block of Size or greater appears. */
@@ -398,7 +517,7 @@ int list_get_index_of_by_Size(list_t *l, int Size){
 int list_get_index_of_by_Pid(list_t *l, int pid){
  int i = 0;
  node_t *current = l->head;
- if(l->head == NULL){
+ if(l->head == NULL || (l->index != NULL && pidmap_find(l->index, pid) == NULL)){
     return -1;
   }
   
@@ -411,4 +530,50 @@ int list_get_index_of_by_Pid(list_t *l, int pid){
   }
 
   return -1; 
-}
\ No newline at end of file
+}
+/* merges two address ordered chains */
+static node_t *merge_by_address(node_t *a, node_t *b){
+  node_t head;
+  node_t *tail = &head;
+
+  while(a != NULL && b != NULL){
+    if(a->blk->start <= b->blk->start){
+      tail->next = a;
+      a = a->next;
+    }
+    else{
+      tail->next = b;
+      b = b->next;
+    }
+    tail = tail->next;
+  }
+  tail->next = a != NULL ? a : b;
+  return head.next;
+}
+
+static node_t *sort_by_address(node_t *first, int n){
+  node_t *second, *last;
+  int i;
+
+  if(n <= 1){
+    if(first != NULL)
+      first->next = NULL;
+    return first;
+  }
+  last = first;
+  for(i = 1; i < n / 2; i++)
+    last = last->next;
+  second = last->next;
+  last->next = NULL;
+  return merge_by_address(sort_by_address(first, n / 2), sort_by_address(second, n - n / 2));
+}
+
+void list_sort_by_address(list_t *l){
+  node_t *current, *prev = NULL;
+
+  l->head = sort_by_address(l->head, list_length(l));
+  for(current = l->head; current != NULL; current = current->next){
+    current->prev = prev;
+    prev = current;
+  }
+}
@@ -4,8 +4,14 @@
 //
 // <Author>
 
+#ifndef LIST_H
+#define LIST_H
+
 #include <stdbool.h>
 
+#include "pool.h"
+#include "pidmap.h"
+
 typedef struct block {
     int pid;   // pid
 	int start;
@@ -14,16 +20,22 @@ typedef struct block {
 
 /* Defines the node structure. Each node contains its element, and points to the
  * next node in the list. The last element in the list should have NULL as its
- * next pointer. */
+ * next pointer. prev is kept by the list functions but not by code that
+ * relinks FREE_LIST itself, so it is only relied on in indexed lists. */
 typedef struct node {
   block_t *blk;
 	struct node *next;
+  struct node *prev;
 }node_t;
 
-/* Defines the list structure, which simply points to the first node in the
- * list. */
+/* Defines the list structure, which points to the first node in the list
+ * and to the pools its nodes and blocks come from. Lists sharing a pair of
+ * pools can pass nodes and blocks to each other. */
 struct list {
 	node_t *head;
+  pool_t *node_pool;     // NULL: nodes come from malloc
+  pool_t *block_pool;    // NULL: blocks come from malloc
+  pidmap_t *index;       // NULL: PIDs are found by walking the list
 };
 typedef struct list list_t;
 
@@ -31,10 +43,23 @@ typedef struct list list_t;
  * the user should be able to allocate and free all the memory required for
  * this linked list library. */
 list_t *list_alloc();
+list_t *list_alloc_pooled(pool_t *node_pool, pool_t *block_pool);
 node_t *node_alloc(block_t *blk);
 
+/* Indexes the nodes of the list by the PID of their block from now on,
+ * which makes list_remove_by_pid and list_is_in_by_pid O(1). Blocks must
+ * not change PID while they are in the list. */
+void list_index_by_pid(list_t *l);
+
+/* Frees the list structure only; pooled nodes and blocks go back with their
+ * pools. */
 void list_free(list_t *l);
 
+/* Blocks and unlinked nodes of the list, from and back to its pools. */
+block_t *list_block_alloc(list_t *l);
+void list_block_free(list_t *l, block_t *blk);
+void list_node_free(list_t *l, node_t *node);
+
 /* Prints the list in some format. */
 void list_print(list_t *l);
 
@@ -54,6 +79,10 @@ block_t* list_remove_from_back(list_t *l);
 block_t* list_remove_from_front(list_t *l);
 block_t* list_remove_at_index(list_t *l, int index);
 
+/* Removes a block of pid, the one at the lowest address in an indexed list
+ * and the first one otherwise. Returns NULL when pid holds no block. */
+block_t* list_remove_by_pid(list_t *l, int pid);
+
 /* Checks to see if block of Size exists in the list. */
 bool list_is_in(list_t *l, block_t *blk);
 
@@ -83,3 +112,8 @@ bool compareBlks(block_t* a, block_t *b);
 
 /* join adjacent nodes who blocks are physically next to each other */
 void list_coalese_nodes(list_t *l);
+
+/* Sorts the nodes in ascending order by address in place, O(n log n). */
+void list_sort_by_address(list_t *l);
+
+#endif				// LIST_H
@@ -0,0 +1,617 @@
+// memory.c
+//
+// Allocation policies of the MMU simulator. First, best and worst fit work on
+// FREE_LIST directly; the buddy and TLSF policies keep their own free block
+// index and share only ALLOC_LIST.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list.h"
+#include "pool.h"
+#include "memory.h"
+
+/* objects per pool chunk, one chunk covers a few hundred live blocks */
+#define POOL_CHUNK 512
+
+int allocate_memory(list_t * freelist, list_t * alloclist, int pid, int blocksize, int policy, long long * searched) {
+   node_t *current = freelist->head;
+    node_t *prev = NULL;
+
+    node_t *selected_prev = NULL;
+    node_t *selected_node = NULL;
+
+    if(policy == POLICY_FIRSTFIT){ // First Fit
+        while(current != NULL){
+            int current_size = current->blk->end - current->blk->start + 1;
+            *searched += 1;
+            if(current_size >= blocksize){
+                selected_prev = prev;
+                selected_node = current;
+                break;
+            }
+            prev = current;
+            current = current->next;
+        }
+    }
+    else if(policy == POLICY_BESTFIT){ // Best Fit
+        int smallest_diff = __INT32_MAX__;
+        while(current != NULL){
+            int current_size = current->blk->end - current->blk->start + 1;
+            *searched += 1;
+            if(current_size >= blocksize){
+                int diff = current_size - blocksize;
+                if(diff < smallest_diff){
+                    smallest_diff = diff;
+                    selected_prev = prev;
+                    selected_node = current;
+                }
+            }
+            prev = current;
+            current = current->next;
+        }
+    }
+    else if(policy == POLICY_WORSTFIT){ // Worst Fit
+        int largest_diff = -1;
+        while(current != NULL){
+            int current_size = current->blk->end - current->blk->start + 1;
+            *searched += 1;
+            if(current_size >= blocksize){
+                int diff = current_size - blocksize;
+                if(diff > largest_diff){
+                    largest_diff = diff;
+                    selected_prev = prev;
+                    selected_node = current;
+                }
+            }
+            prev = current;
+            current = current->next;
+        }
+    }
+    else{
+        printf("Error: Unknown Memory Management Policy\n");
+        return -1;
+    }
+
+    if(selected_node == NULL){
+        return -1;
+    }
+
+    // Remove selected_node from freelist before the fragment is re-inserted,
+    // otherwise an insert at the head leaves selected_prev stale
+    if(selected_prev == NULL){
+        freelist->head = selected_node->next;
+    }
+    else{
+        selected_prev->next = selected_node->next;
+    }
+
+    // Allocate memory from selected_node
+    int allocated_start = selected_node->blk->start;
+    int allocated_end = allocated_start + blocksize - 1;
+
+    // Create allocated block
+    block_t *allocated_blk = list_block_alloc(alloclist);
+    allocated_blk->pid = pid;
+    allocated_blk->start = allocated_start;
+    allocated_blk->end = allocated_end;
+
+    // Insert allocated block into alloclist in ascending order by address
+    list_add_ascending_by_address(alloclist, allocated_blk);
+
+    // Handle fragmentation
+    int remaining_size = (selected_node->blk->end - selected_node->blk->start + 1) - blocksize;
+    if(remaining_size > 0){
+        block_t *fragment = list_block_alloc(freelist);
+        fragment->pid = 0;
+        fragment->start = allocated_end + 1;
+        fragment->end = selected_node->blk->end;
+
+        // Insert the fragment back into freelist based on policy
+        if(policy == POLICY_FIRSTFIT){ // First Fit
+            list_add_to_back(freelist, fragment);
+        }
+        else if(policy == POLICY_BESTFIT){ // Best Fit
+            list_add_ascending_by_blocksize(freelist, fragment);
+        }
+        else if(policy == POLICY_WORSTFIT){ // Worst Fit
+            list_add_descending_by_blocksize(freelist, fragment);
+        }
+    }
+
+    // Free the selected_node
+    list_block_free(freelist, selected_node->blk);
+    list_node_free(freelist, selected_node);
+    return 0;
+}
+
+int deallocate_memory(list_t * alloclist, list_t * freelist, int pid, int policy) { 
+    // Find the allocated block with the given pid and remove it from
+    // alloclist, through its PID index when it has one
+    block_t *blk = list_remove_by_pid(alloclist, pid);
+
+    if(blk == NULL){
+        return -1;
+    }
+
+    // Prepare the block to be freed
+    blk->pid = 0;
+
+    // Insert the block back into freelist based on policy
+    if(policy == POLICY_FIRSTFIT){ // First Fit
+        list_add_to_back(freelist, blk);
+    }
+    else if(policy == POLICY_BESTFIT){ // Best Fit
+        list_add_ascending_by_blocksize(freelist, blk);
+    }
+    else if(policy == POLICY_WORSTFIT){ // Worst Fit
+        list_add_descending_by_blocksize(freelist, blk);
+    }
+    else if(policy == POLICY_NEXTFIT){ // Next Fit
+        list_add_ascending_by_address(freelist, blk);
+    }
+    else{
+        printf("Error: Unknown Memory Management Policy\n");
+        // Since policy is unknown, default to adding to back
+        list_add_to_back(freelist, blk);
+    }
+
+    return 0;
+}
+
+/* Next fit keeps FREE_LIST in address order and splits blocks in place, so
+ * the scan can pick up where the previous one stopped. *rover is the node
+ * before the resume point, which makes an exact fit O(1) to unlink; the
+ * callers must re-seat it with find_rover whenever FREE_LIST is rebuilt. */
+int allocate_next_fit(list_t * freelist, list_t * alloclist, node_t ** rover, int pid, int blocksize, long long * searched) {
+    node_t *prev = *rover;
+    node_t *current = prev != NULL ? prev->next : freelist->head;
+    node_t *first;
+    int wrapped = 0;
+
+    if(current == NULL){   // the rover is the last node, wrap to the head
+        prev = NULL;
+        current = freelist->head;
+    }
+    first = current;
+
+    while(current != NULL){
+        *searched += 1;
+        if(current->blk->end - current->blk->start + 1 >= blocksize)
+            break;
+        prev = current;
+        current = current->next;
+        if(current == NULL && !wrapped){
+            wrapped = 1;
+            prev = NULL;
+            current = freelist->head;
+        }
+        if(current == first){
+            current = NULL;
+            break;
+        }
+    }
+
+    if(current == NULL){
+        return -1;
+    }
+
+    block_t *allocated_blk = list_block_alloc(alloclist);
+    allocated_blk->pid = pid;
+    allocated_blk->start = current->blk->start;
+    allocated_blk->end = current->blk->start + blocksize - 1;
+    list_add_ascending_by_address(alloclist, allocated_blk);
+
+    if(current->blk->end - current->blk->start + 1 > blocksize){
+        // split in place, the next request starts with the remainder
+        current->blk->start += blocksize;
+    }
+    else{
+        if(prev == NULL)
+            freelist->head = current->next;
+        else
+            prev->next = current->next;
+        list_block_free(freelist, current->blk);
+        list_node_free(freelist, current);
+    }
+
+    *rover = prev;
+    return 0;
+}
+
+/* Node of an address ordered FREE_LIST to resume next fit after, once the
+ * list has been rebuilt: the last one starting at or before address, which
+ * is the block the old rover was merged into. */
+node_t* find_rover(list_t * freelist, int address) {
+    node_t *current = freelist->head;
+    node_t *found = NULL;
+
+    if(address < 0)
+        return NULL;
+
+    while(current != NULL && current->blk->start <= address){
+        found = current;
+        current = current->next;
+    }
+    return found;
+}
+
+list_t* coalese_memory(list_t * list){
+  list_sort_by_address(list);  // relinks the nodes, nothing is allocated
+  
+  //combine physically adjacent blocks
+  
+  list_coalese_nodes(list);
+        
+  return list;
+}
+
+/* Moves the blocks of an address ordered list down so they are packed from
+ * address 0, adding the size of each block that moved to moved. Returns the
+ * first address after the last block. */
+int compact_allocated(list_t * alloclist, int * moved){
+    node_t *current = alloclist->head;
+    int start = 0, size;
+
+    while(current != NULL){
+        size = current->blk->end - current->blk->start + 1;
+        if(current->blk->start != start){
+            *moved += size;
+            current->blk->start = start;
+            current->blk->end = start + size - 1;
+        }
+        start += size;
+        current = current->next;
+    }
+    return start;
+}
+
+int compact_memory(list_t * freelist, list_t * alloclist, int size){
+    block_t *blk;
+    int start, moved = 0;
+
+    while((blk = list_remove_from_front(freelist)) != NULL)
+        list_block_free(freelist, blk);
+
+    start = compact_allocated(alloclist, &moved);
+    if(start < size){
+        blk = list_block_alloc(freelist);
+        blk->pid = 0;
+        blk->start = start;
+        blk->end = size - 1;
+        list_add_to_front(freelist, blk);
+    }
+    return moved;
+}
+
+void print_list(list_t * list, char * message){
+    node_t *current = list->head;
+    block_t *blk;
+    int i = 0;
+  
+    printf("%s:\n", message);
+  
+    while(current != NULL){
+        blk = current->blk;
+        printf("Block %d:\t START: %d\t END: %d", i, blk->start, blk->end);
+      
+        if(blk->pid != 0)
+            printf("\t PID: %d\n", blk->pid);
+        else  
+            printf("\n");
+      
+        current = current->next;
+        i += 1;
+    }
+}
+
+memory_t *memory_alloc(int size, int policy, int flags){
+    return memory_alloc_granular(size, policy, flags, BITMAP_GRANULARITY);
+}
+
+memory_t *memory_alloc_granular(int size, int policy, int flags, int granularity){
+    memory_t *m = malloc(sizeof(memory_t));
+    block_t *partition;
+
+    m->policy = policy;
+    m->size = size;
+    m->node_pool = pool_alloc(sizeof(node_t), POOL_CHUNK);
+    m->block_pool = pool_alloc(sizeof(block_t), POOL_CHUNK);
+    m->free_list = list_alloc_pooled(m->node_pool, m->block_pool);
+    m->alloc_list = list_alloc_pooled(m->node_pool, m->block_pool);
+    list_index_by_pid(m->alloc_list);    // frees find their block in O(1)
+    m->rover = NULL;
+    m->buddy = NULL;
+    m->tlsf = NULL;
+    m->index = NULL;
+    m->bitmap = NULL;
+    m->slab = (flags & MEMORY_SLAB) ? slab_alloc() : NULL;
+    m->quiet = (flags & MEMORY_QUIET) != 0;
+    m->free_all = (flags & MEMORY_FREEALL) != 0;
+    m->alloc_failures = 0;
+    m->searched = 0;
+    m->compact_threshold = 0;
+    m->compactions = 0;
+    m->bytes_moved = 0;
+
+    if(policy == POLICY_BUDDY)
+        m->buddy = buddy_alloc(size);
+    else if(policy == POLICY_TLSF)
+        m->tlsf = tlsf_alloc(size);
+    else if(policy == POLICY_BITMAP)
+        m->bitmap = bitmap_alloc(size, granularity);
+    else if(policy != POLICY_NEXTFIT && (flags & (MEMORY_INDEXED | MEMORY_EAGER)))
+        m->index = freetree_alloc(size, policy, (flags & MEMORY_EAGER) != 0);
+    else {
+        partition = list_block_alloc(m->free_list);   // create the partition meta data
+        partition->pid = 0;
+        partition->start = 0;
+        partition->end = size + partition->start - 1;
+        list_add_to_front(m->free_list, partition);
+    }
+
+    return m;
+}
+
+void memory_free(memory_t *m){
+    list_free(m->free_list);
+    list_free(m->alloc_list);
+    pool_free(m->node_pool);    // every node and block of both lists
+    pool_free(m->block_pool);
+    if(m->buddy != NULL)
+        buddy_free(m->buddy);
+    if(m->tlsf != NULL)
+        tlsf_free(m->tlsf);
+    if(m->index != NULL)
+        freetree_free(m->index);
+    if(m->bitmap != NULL)
+        bitmap_free(m->bitmap);
+    if(m->slab != NULL)
+        slab_free(m->slab);
+    free(m);
+}
+
+static int allocate(memory_t *m, int pid, int blocksize){
+    if(m->policy == POLICY_BUDDY)
+        return buddy_allocate(m->buddy, m->alloc_list, pid, blocksize, &m->searched);
+    else if(m->policy == POLICY_TLSF)
+        return tlsf_allocate(m->tlsf, m->alloc_list, pid, blocksize, &m->searched);
+    else if(m->policy == POLICY_BITMAP)
+        return bitmap_allocate(m->bitmap, m->alloc_list, pid, blocksize, &m->searched);
+    else if(m->index != NULL)
+        return freetree_allocate(m->index, m->alloc_list, pid, blocksize, &m->searched);
+    else if(m->policy == POLICY_NEXTFIT)
+        return allocate_next_fit(m->free_list, m->alloc_list, &m->rover, pid, blocksize, &m->searched);
+    else
+        return allocate_memory(m->free_list, m->alloc_list, pid, blocksize, m->policy, &m->searched);
+}
+
+/* Compacts when the free space is more fragmented than compact_threshold.
+ * The buddy free space is still split into aligned blocks right after a
+ * compaction, so the threshold would fire on almost every free; buddy
+ * memory is only compacted on request. */
+static int auto_compact(memory_t *m){
+    long long moved = m->bytes_moved;
+
+    if(m->compact_threshold <= 0 || m->policy == POLICY_BUDDY)
+        return 0;
+    if(memory_external_frag(m) <= m->compact_threshold)
+        return 0;
+
+    memory_compact(m);
+    if(!m->quiet)
+        printf("COMPACT: moved %lld bytes\n", m->bytes_moved - moved);
+    return 1;
+}
+
+static int deallocate(memory_t *m, int pid){
+    if(m->policy == POLICY_BUDDY)
+        return buddy_deallocate(m->buddy, m->alloc_list, pid);
+    else if(m->policy == POLICY_TLSF)
+        return tlsf_deallocate(m->tlsf, m->alloc_list, pid);
+    else if(m->policy == POLICY_BITMAP)
+        return bitmap_deallocate(m->bitmap, m->alloc_list, pid);
+    else if(m->index != NULL)
+        return freetree_deallocate(m->index, m->alloc_list, pid);
+    else
+        return deallocate_memory(m->alloc_list, m->free_list, pid, m->policy);
+}
+
+/* Serves pid from a slab of class, making a new slab through the policy
+ * when every slab is full. A request whose slab does not fit is left to
+ * the policy. */
+static int allocate_from_slab(memory_t *m, int class, int pid, int blocksize){
+    slab_cache_t *c = m->slab;
+
+    if(slab_get(c, class, pid) == 0){
+        c->hits += 1;
+        return 0;
+    }
+    if(allocate(m, slab_next_pid(c), slab_chunk_bytes(c, class)) != 0){
+        c->fallbacks += 1;
+        return allocate(m, pid, blocksize);
+    }
+    slab_grow(c, class);
+    c->refills += 1;
+    return slab_get(c, class, pid);
+}
+
+/* Gives every empty slab back to the policy. Returns the number freed. */
+static int reclaim_slabs(memory_t *m){
+    int pid, n = 0;
+
+    while((pid = slab_take_empty(m->slab)) != 0){
+        deallocate(m, pid);
+        n += 1;
+    }
+    if(n > 0)
+        m->slab->reclaims += 1;
+    return n;
+}
+
+int memory_allocate(memory_t *m, int pid, int blocksize){
+    int class = m->slab != NULL ? slab_class_for(m->slab, blocksize) : -1;
+    int result;
+
+    if(class != -1)
+        result = allocate_from_slab(m, class, pid, blocksize);
+    else
+        result = allocate(m, pid, blocksize);
+
+    // under memory pressure the idle slabs go back to the policy
+    if(result != 0 && m->slab != NULL && reclaim_slabs(m) > 0)
+        result = class != -1 ? allocate_from_slab(m, class, pid, blocksize) : allocate(m, pid, blocksize);
+
+    // the request may fit once the free space is in one piece
+    if(result != 0 && blocksize <= memory_free_bytes(m) && auto_compact(m))
+        result = allocate(m, pid, blocksize);
+
+    if(result != 0){
+        m->alloc_failures += 1;
+        if(!m->quiet)
+            printf("Error: Memory Allocation %d blocks\n", blocksize);
+    }
+    return result;
+}
+
+int memory_deallocate(memory_t *m, int pid){
+    int result;
+
+    if(m->free_all)
+        return memory_deallocate_all(m, pid) > 0 ? 0 : -1;
+
+    // a slab object goes back to its slab, the free space does not change
+    if(m->slab != NULL && slab_put(m->slab, pid) == 0)
+        return 0;
+
+    result = deallocate(m, pid);
+    if(result != 0 && !m->quiet)
+        printf("Error: Can't locate Memory Used by PID: %d\n", pid);
+    else if(result == 0)
+        auto_compact(m);
+    return result;
+}
+
+int memory_deallocate_all(memory_t *m, int pid){
+    int slab_objects = 0, blocks = 0;
+
+    while(m->slab != NULL && slab_put(m->slab, pid) == 0)
+        slab_objects += 1;
+    while(deallocate(m, pid) == 0)
+        blocks += 1;
+
+    if(slab_objects + blocks == 0 && !m->quiet)
+        printf("Error: Can't locate Memory Used by PID: %d\n", pid);
+    else if(blocks > 0)
+        auto_compact(m);
+    return slab_objects + blocks;
+}
+
+void memory_coalesce(memory_t *m){
+    int address;
+
+    // buddy and TLSF merge neighbours on every free, free bitmap units need no merging
+    if(m->index != NULL)
+        freetree_coalesce(m->index);
+    else if(m->policy == POLICY_NEXTFIT){
+        address = m->rover != NULL ? m->rover->blk->start : -1;
+        m->free_list = coalese_memory(m->free_list);
+        m->rover = find_rover(m->free_list, address);
+    }
+    else if(m->policy != POLICY_BUDDY && m->policy != POLICY_TLSF && m->policy != POLICY_BITMAP)
+        m->free_list = coalese_memory(m->free_list);
+}
+
+void memory_compact(memory_t *m){
+    int moved;
+
+    if(m->policy == POLICY_BUDDY)
+        moved = buddy_compact(m->buddy, m->alloc_list);
+    else if(m->policy == POLICY_TLSF)
+        moved = tlsf_compact(m->tlsf);
+    else if(m->policy == POLICY_BITMAP)
+        moved = bitmap_compact(m->bitmap, m->alloc_list);
+    else if(m->index != NULL)
+        moved = freetree_compact(m->index, m->alloc_list);
+    else {
+        moved = compact_memory(m->free_list, m->alloc_list, m->size);
+        m->rover = NULL;    // FREE_LIST is a single new block now
+    }
+
+    m->compactions += 1;
+    m->bytes_moved += moved;
+}
+
+void memory_print(memory_t *m){
+    if(m->policy == POLICY_TLSF){
+        tlsf_print(m->tlsf, "Free Memory", "\nAllocated Memory");
+        if(m->slab != NULL)
+            slab_print(m->slab, m->alloc_list, "\nSlab Memory");
+        return;
+    }
+
+    if(m->policy == POLICY_BUDDY)
+        buddy_print(m->buddy, "Free Memory");
+    else if(m->policy == POLICY_BITMAP)
+        bitmap_print(m->bitmap, "Free Memory");
+    else if(m->index != NULL)
+        freetree_print(m->index, "Free Memory");
+    else
+        print_list(m->free_list, "Free Memory");
+    print_list(m->alloc_list,"\nAllocated Memory");
+    if(m->slab != NULL)
+        slab_print(m->slab, m->alloc_list, "\nSlab Memory");
+}
+
+int memory_internal_frag(memory_t *m){
+    if(m->bitmap != NULL)
+        return m->bitmap->internal_frag;
+    return m->buddy != NULL ? m->buddy->internal_frag : 0;
+}
+
+int memory_free_bytes(memory_t *m){
+    node_t *current;
+    int total = 0;
+
+    if(m->policy == POLICY_BUDDY)
+        return m->buddy->free_bytes;
+    else if(m->policy == POLICY_TLSF)
+        return m->tlsf->free_bytes;
+    else if(m->policy == POLICY_BITMAP)
+        return bitmap_free_bytes(m->bitmap);
+    else if(m->index != NULL)
+        return m->index->free_bytes;
+
+    for(current = m->free_list->head; current != NULL; current = current->next)
+        total += current->blk->end - current->blk->start + 1;
+    return total;
+}
+
+int memory_largest_free(memory_t *m){
+    node_t *current;
+    int size, largest = 0;
+
+    if(m->policy == POLICY_BUDDY)
+        return buddy_largest_free(m->buddy);
+    else if(m->policy == POLICY_TLSF)
+        return tlsf_largest_free(m->tlsf);
+    else if(m->policy == POLICY_BITMAP)
+        return bitmap_largest_free(m->bitmap);
+    else if(m->index != NULL)
+        return freetree_largest_free(m->index);
+
+    for(current = m->free_list->head; current != NULL; current = current->next){
+        size = current->blk->end - current->blk->start + 1;
+        if(size > largest)
+            largest = size;
+    }
+    return largest;
+}
+
+double memory_external_frag(memory_t *m){
+    int total = memory_free_bytes(m);
+
+    if(total == 0)
+        return 0.0;
+    return 100.0 * (total - memory_largest_free(m)) / total;
+}
@@ -0,0 +1,110 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "list.h"
+#include "buddy.h"
+#include "tlsf.h"
+#include "freetree.h"
+#include "bitmap.h"
+#include "slab.h"
+
+/**
+ * Memory management policies of the simulator. A memory_t owns the free and
+ * allocated block lists of one partition plus whatever extra structure the
+ * selected policy needs, so several of them can be driven side by side.
+ */
+
+#define POLICY_FIRSTFIT 1
+#define POLICY_BESTFIT  2
+#define POLICY_WORSTFIT 3
+#define POLICY_BUDDY    4
+#define POLICY_TLSF     5
+#define POLICY_NEXTFIT  6
+#define POLICY_BITMAP   7
+
+/* Options for memory_alloc, or-ed together. */
+#define MEMORY_INDEXED  0x1     // first/best/worst fit use freetree instead of FREE_LIST, ignored by next fit
+#define MEMORY_EAGER    0x2     // merge freed blocks with their neighbours at once, implies MEMORY_INDEXED
+#define MEMORY_QUIET    0x4     // do not print failed requests
+#define MEMORY_COMPACT  0x8     // COALESCE/COMPACT records compact instead of only coalescing
+#define MEMORY_SLAB     0x10    // serve recurring request sizes from slabs ahead of the policy
+#define MEMORY_FREEALL  0x20    // memory_deallocate frees every block of the PID, not only one
+
+typedef struct memory {
+  int policy;
+  int size;              // partition size in bytes
+  list_t *free_list;     // FREE_LIST, all free blocks (PID is always zero)
+  list_t *alloc_list;    // ALLOC_LIST, all allocated blocks
+  pool_t *node_pool;     // nodes and blocks of both lists, and of ALLOC_LIST for the other policies
+  pool_t *block_pool;
+  node_t *rover;         // next fit resumes its scan after this FREE_LIST node, at the head if NULL
+  buddy_t *buddy;        // order free lists, only used by POLICY_BUDDY
+  tlsf_t *tlsf;          // size classes, only used by POLICY_TLSF
+  freetree_t *index;     // tree indexed free space, only with MEMORY_INDEXED
+  bitmap_t *bitmap;      // one bit per unit, only used by POLICY_BITMAP
+  slab_cache_t *slab;    // size class slabs, only with MEMORY_SLAB
+  int quiet;
+  int free_all;          // MEMORY_FREEALL
+  int alloc_failures;    // requests that could not be satisfied
+  long long searched;    // free blocks (or tree nodes, size classes) examined by all requests
+  int compact_threshold; // compact once external fragmentation exceeds this percentage, 0 never
+  int compactions;
+  long long bytes_moved; // total bytes copied by all compactions
+}memory_t;
+
+/* Creates the partition of size bytes managed by the given policy. */
+memory_t *memory_alloc(int size, int policy, int flags);
+
+/* Same, with the bytes per bit of POLICY_BITMAP instead of
+ * BITMAP_GRANULARITY. Other policies ignore granularity. */
+memory_t *memory_alloc_granular(int size, int policy, int flags, int granularity);
+void memory_free(memory_t *m);
+
+/* Both return 0 on success and -1 when the request could not be satisfied,
+ * which is also reported on stdout unless the memory is quiet. With a
+ * compact_threshold set, a free that leaves the free space more fragmented
+ * than the threshold compacts it, and so does a failed allocation that
+ * compaction can satisfy. POLICY_BUDDY never compacts on its own. With
+ * MEMORY_SLAB a failed allocation first gives the empty slabs back. */
+int memory_allocate(memory_t *m, int pid, int blocksize);
+int memory_deallocate(memory_t *m, int pid);
+
+/* A PID may hold several blocks. memory_deallocate frees the lowest
+ * addressed one, this frees all of them and returns how many there were.
+ * The blocks are found through the PID index of ALLOC_LIST, so each free
+ * costs the same however many PIDs are live. */
+int memory_deallocate_all(memory_t *m, int pid);
+
+/* Merges physically adjacent free blocks. */
+void memory_coalesce(memory_t *m);
+
+/* Slides every allocated block toward address 0 so the free space becomes
+ * one block (for POLICY_BUDDY, as few aligned blocks as possible). The bytes
+ * moved are added to m->bytes_moved. */
+void memory_compact(memory_t *m);
+
+/* Prints the free and allocated blocks. */
+void memory_print(memory_t *m);
+
+/* Bytes lost inside allocated blocks, non zero only for POLICY_BUDDY and
+ * POLICY_BITMAP. */
+int memory_internal_frag(memory_t *m);
+
+/* Total free bytes and size of the largest free block. */
+int memory_free_bytes(memory_t *m);
+int memory_largest_free(memory_t *m);
+
+/* Share of the free space outside the largest free block, in percent. */
+double memory_external_frag(memory_t *m);
+
+/* List based policies, operating directly on FREE_LIST and ALLOC_LIST. */
+int allocate_memory(list_t * freelist, list_t * alloclist, int pid, int blocksize, int policy, long long * searched);
+int deallocate_memory(list_t * alloclist, list_t * freelist, int pid, int policy);
+int allocate_next_fit(list_t * freelist, list_t * alloclist, node_t ** rover, int pid, int blocksize, long long * searched);
+node_t* find_rover(list_t * freelist, int address);
+list_t* coalese_memory(list_t * list);
+int compact_memory(list_t * freelist, list_t * alloclist, int size);
+int compact_allocated(list_t * alloclist, int * moved);
+void print_list(list_t * list, char * message);
+
+#endif				// MEMORY_H
@@ -4,6 +4,8 @@
 #include <string.h>
 #include "list.h"
 #include "util.h"
+#include "memory.h"
+#include "stats.h"
 
 void TOUPPER(char * arr){
   
@@ -12,276 +14,181 @@ void TOUPPER(char * arr){
     }
 }
 
-void get_input(char *args[], int input[][2], int *n, int *size, int *policy) 
+typedef struct options {
+    int policy;
+    int flags;           // MEMORY_* flags for memory_alloc
+    int threshold;       // auto-compaction threshold in percent, 0 for none
+    int sample;          // print a sample line every this many records, 0 for none
+    int csv;
+    int stats;           // print the summary at the end
+    int granularity;     // bytes per bit of -BITMAP
+}options_t;
+
+void print_usage(){
+    printf("usage: ./mmu <input file> -{F | B | W | N | BUDDY | TLSF | BITMAP} [-GRANULARITY=<bytes>] [-INDEX] [-EAGER] [-SLAB] [-FREEALL] [-COMPACT] [-AUTOCOMPACT=<percent>] [-STATS] [-QUIET] [-SAMPLE=<records>] [-CSV]  \n(F=FIFO | B=BESTFIT | W-WORSTFIT | N=NEXTFIT | BUDDY=BUDDY SYSTEM | TLSF=TWO-LEVEL SEGREGATED FIT | BITMAP=ONE BIT PER UNIT)\n");
+    printf("  -N  next fit, resumes each search where the previous one stopped\n");
+    printf("  -GRANULARITY=<bytes>  unit of -BITMAP, requests are rounded up to it (default %d)\n", BITMAP_GRANULARITY);
+    printf("  -INDEX  index F/B/W free space with balanced trees instead of FREE_LIST\n");
+    printf("  -EAGER  merge a freed block with its free neighbours at once (implies -INDEX)\n");
+    printf("  -SLAB  serve sizes requested %d times or more (up to %d bytes) from slabs ahead of the policy\n", SLAB_PROMOTE, SLAB_MAX_OBJECT);
+    printf("  -FREEALL  a deallocation frees every block the PID holds, not only the lowest one\n");
+    printf("  -COMPACT  COALESCE/COMPACT records slide allocated blocks down to address 0\n");
+    printf("  -AUTOCOMPACT=<percent>  compact whenever external fragmentation exceeds percent\n");
+    printf("  -STATS  print a summary of the run at the end, with timing and peak RSS\n");
+    printf("  -QUIET  print only the summary, not the lists after every record\n");
+    printf("  -SAMPLE=<records>  print the free space metrics every so many records\n");
+    printf("  -CSV  print the samples and the summary as CSV\n");
+}
+
+/* Opens the input file and reads the partition size and options. The
+ * records are left in the returned file, to be read one at a time. */
+FILE *get_input(int argc, char *args[], int *size, options_t *opt) 
 {
-  	FILE *input_file = fopen(args[1], "r");
-	  if (!input_file) {
-		    fprintf(stderr, "Error: Invalid filepath\n");
-		    fflush(stdout);
-		    exit(0);
-	  }
+    FILE *input_file;
 
-    parse_file(input_file, input, n, size);
-  
-    fclose(input_file);
-  
     TOUPPER(args[2]);
   
     if((strcmp(args[2],"-F") == 0) || (strcmp(args[2],"-FIFO") == 0))
-        *policy = 1;
+        opt->policy = POLICY_FIRSTFIT;
     else if((strcmp(args[2],"-B") == 0) || (strcmp(args[2],"-BESTFIT") == 0))
-        *policy = 2;
+        opt->policy = POLICY_BESTFIT;
     else if((strcmp(args[2],"-W") == 0) || (strcmp(args[2],"-WORSTFIT") == 0))
-        *policy = 3;
+        opt->policy = POLICY_WORSTFIT;
+    else if(strcmp(args[2],"-BUDDY") == 0)
+        opt->policy = POLICY_BUDDY;
+    else if(strcmp(args[2],"-TLSF") == 0)
+        opt->policy = POLICY_TLSF;
+    else if((strcmp(args[2],"-N") == 0) || (strcmp(args[2],"-NEXTFIT") == 0))
+        opt->policy = POLICY_NEXTFIT;
+    else if(strcmp(args[2],"-BITMAP") == 0)
+        opt->policy = POLICY_BITMAP;
     else {
-       printf("usage: ./mmu <input file> -{F | B | W }  \n(F=FIFO | B=BESTFIT | W-WORSTFIT)\n");
+       print_usage();
        exit(1);
     }
-        
-}
-
-void allocate_memory(list_t * freelist, list_t * alloclist, int pid, int blocksize, int policy) {
-   node_t *current = freelist->head;
-    node_t *prev = NULL;
-
-    node_t *selected_prev = NULL;
-    node_t *selected_node = NULL;
 
-    if(policy == 1){ // First Fit
-        while(current != NULL){
-            int current_size = current->blk->end - current->blk->start + 1;
-            if(current_size >= blocksize){
-                selected_prev = prev;
-                selected_node = current;
-                break;
-            }
-            prev = current;
-            current = current->next;
-        }
-    }
-    else if(policy == 2){ // Best Fit
-        int smallest_diff = __INT32_MAX__;
-        while(current != NULL){
-            int current_size = current->blk->end - current->blk->start + 1;
-            if(current_size >= blocksize){
-                int diff = current_size - blocksize;
-                if(diff < smallest_diff){
-                    smallest_diff = diff;
-                    selected_prev = prev;
-                    selected_node = current;
-                }
-            }
-            prev = current;
-            current = current->next;
+    opt->flags = 0;
+    opt->threshold = 0;
+    opt->sample = 0;
+    opt->csv = 0;
+    opt->stats = 0;
+    opt->granularity = BITMAP_GRANULARITY;
+    for(int i = 3; i < argc; i++){
+        TOUPPER(args[i]);
+        if(strcmp(args[i],"-INDEX") == 0)
+            opt->flags |= MEMORY_INDEXED;
+        else if(strcmp(args[i],"-EAGER") == 0)
+            opt->flags |= MEMORY_EAGER;
+        else if(strcmp(args[i],"-COMPACT") == 0)
+            opt->flags |= MEMORY_COMPACT;
+        else if(strcmp(args[i],"-SLAB") == 0)
+            opt->flags |= MEMORY_SLAB;
+        else if(strcmp(args[i],"-FREEALL") == 0)
+            opt->flags |= MEMORY_FREEALL;
+        else if(strcmp(args[i],"-QUIET") == 0)
+            opt->flags |= MEMORY_QUIET;
+        else if(strcmp(args[i],"-CSV") == 0)
+            opt->csv = 1;
+        else if(strcmp(args[i],"-STATS") == 0)
+            opt->stats = 1;
+        else if(sscanf(args[i], "-AUTOCOMPACT=%d", &opt->threshold) == 1 && opt->threshold > 0 && opt->threshold < 100)
+            continue;
+        else if(sscanf(args[i], "-SAMPLE=%d", &opt->sample) == 1 && opt->sample > 0)
+            continue;
+        else if(sscanf(args[i], "-GRANULARITY=%d", &opt->granularity) == 1 && opt->granularity > 0)
+            continue;
+        else {
+            print_usage();
+            exit(1);
         }
     }
-    else if(policy == 3){ // Worst Fit
-        int largest_diff = -1;
-        while(current != NULL){
-            int current_size = current->blk->end - current->blk->start + 1;
-            if(current_size >= blocksize){
-                int diff = current_size - blocksize;
-                if(diff > largest_diff){
-                    largest_diff = diff;
-                    selected_prev = prev;
-                    selected_node = current;
-                }
-            }
-            prev = current;
-            current = current->next;
-        }
-    }
-    else{
-        printf("Error: Unknown Memory Management Policy\n");
-        return;
-    }
-
-    if(selected_node == NULL){
-        printf("Error: Not Enough Memory\n");
-        return;
+    if((opt->policy == POLICY_NEXTFIT || opt->policy == POLICY_BITMAP) && (opt->flags & (MEMORY_INDEXED | MEMORY_EAGER))){
+        print_usage();
+        exit(1);
     }
 
-    // Allocate memory from selected_node
-    int allocated_start = selected_node->blk->start;
-    int allocated_end = allocated_start + blocksize - 1;
-
-    // Create allocated block
-    block_t *allocated_blk = malloc(sizeof(block_t));
-    allocated_blk->pid = pid;
-    allocated_blk->start = allocated_start;
-    allocated_blk->end = allocated_end;
-
-    // Insert allocated block into alloclist in ascending order by address
-    list_add_ascending_by_address(alloclist, allocated_blk);
-
-    // Handle fragmentation
-    int remaining_size = (selected_node->blk->end - selected_node->blk->start + 1) - blocksize;
-    if(remaining_size > 0){
-        block_t *fragment = malloc(sizeof(block_t));
-        fragment->pid = 0;
-        fragment->start = allocated_end + 1;
-        fragment->end = selected_node->blk->end;
-
-        // Update the selected node's block to represent the allocated portion
-        selected_node->blk->end = allocated_end;
-
-        // Insert the fragment back into freelist based on policy
-        if(policy == 1){ // First Fit
-            list_add_to_back(freelist, fragment);
-        }
-        else if(policy == 2){ // Best Fit
-            list_add_ascending_by_blocksize(freelist, fragment);
-        }
-        else if(policy == 3){ // Worst Fit
-            list_add_descending_by_blocksize(freelist, fragment);
-        }
-    }
-
-    // If the entire block is allocated, remove it from freelist
-    if((selected_node->blk->end - selected_node->blk->start + 1) == blocksize){
-        // Remove selected_node from freelist
-        if(selected_prev == NULL){
-            freelist->head = selected_node->next;
-        }
-        else{
-            selected_prev->next = selected_node->next;
-        }
-        // Free the selected_node
-        free(selected_node->blk);
-        free(selected_node);
-    }
-}
-
-void deallocate_memory(list_t * alloclist, list_t * freelist, int pid, int policy) { 
-  node_t *current = alloclist->head;
-    node_t *prev = NULL;
-
-    // Find the allocated block with the given pid
-    while(current != NULL && current->blk->pid != pid){
-        prev = current;
-        current = current->next;
-    }
-
-    if(current == NULL){
-        printf("Error: Can't locate Memory Used by PID: %d\n", pid);
-        return;
-    }
-
-    // Remove the block from alloclist
-    if(prev == NULL){
-        alloclist->head = current->next;
-    }
-    else{
-        prev->next = current->next;
-    }
-
-    // Prepare the block to be freed
-    current->blk->pid = 0;
-
-    // Insert the block back into freelist based on policy
-    if(policy == 1){ // First Fit
-        list_add_to_back(freelist, current->blk);
-    }
-    else if(policy == 2){ // Best Fit
-        list_add_ascending_by_blocksize(freelist, current->blk);
-    }
-    else if(policy == 3){ // Worst Fit
-        list_add_descending_by_blocksize(freelist, current->blk);
-    }
-    else{
-        printf("Error: Unknown Memory Management Policy\n");
-        // Since policy is unknown, default to adding to back
-        list_add_to_back(freelist, current->blk);
-    }
-
-    // Free the node
-    free(current);
-}
+  	input_file = fopen(args[1], "r");
+	  if (!input_file) {
+		    fprintf(stderr, "Error: Invalid filepath\n");
+		    fflush(stdout);
+		    exit(0);
+	  }
 
-list_t* coalese_memory(list_t * list){
-  list_t *temp_list = list_alloc();
-  block_t *blk;
-  
-  while((blk = list_remove_from_front(list)) != NULL) {  // sort the list in ascending order by address
-        list_add_ascending_by_address(temp_list, blk);
-  }
-  
-  //combine physically adjacent blocks
-  
-  list_coalese_nodes(temp_list);
-        
-  return temp_list;
-}
+    parse_partition(input_file, size);
+    if(!(opt->flags & MEMORY_QUIET))
+        printf("PARTITION_SIZE = %d\n", *size);
 
-void print_list(list_t * list, char * message){
-    node_t *current = list->head;
-    block_t *blk;
-    int i = 0;
-  
-    printf("%s:\n", message);
-  
-    while(current != NULL){
-        blk = current->blk;
-        printf("Block %d:\t START: %d\t END: %d", i, blk->start, blk->end);
-      
-        if(blk->pid != 0)
-            printf("\t PID: %d\n", blk->pid);
-        else  
-            printf("\n");
-      
-        current = current->next;
-        i += 1;
-    }
+    return input_file;
 }
 
-/* DO NOT MODIFY */
 int main(int argc, char *argv[]) 
 {
-   int PARTITION_SIZE, inputdata[200][2], N = 0, Memory_Mgt_Policy;
+   int PARTITION_SIZE, inputdata[2];
   
-   list_t *FREE_LIST = list_alloc();   // list that holds all free blocks (PID is always zero)
-   list_t *ALLOC_LIST = list_alloc();  // list that holds all allocated blocks
-   int i;
+   FILE *INPUT;        // records are streamed, so traces have no length limit
+   memory_t *MEMORY;   // FREE_LIST, ALLOC_LIST and the policy's own free block index
+   options_t OPTIONS;
+   stats_t STATS;
+   char NAME[64];
+   int quiet;
   
-   if(argc != 3) {
-       printf("usage: ./mmu <input file> -{F | B | W }  \n(F=FIFO | B=BESTFIT | W-WORSTFIT)\n");
+   if(argc < 3) {
+       print_usage();
        exit(1);
    }
   
-   get_input(argv, inputdata, &N, &PARTITION_SIZE, &Memory_Mgt_Policy);
+   INPUT = get_input(argc, argv, &PARTITION_SIZE, &OPTIONS);
+   quiet = (OPTIONS.flags & MEMORY_QUIET) != 0;
   
    // Allocated the initial partition of size PARTITION_SIZE
    
-   block_t * partition = malloc(sizeof(block_t));   // create the partition meta data
-   partition->start = 0;
-   partition->end = PARTITION_SIZE + partition->start - 1;
-                                   
-   list_add_to_front(FREE_LIST, partition);          // add partition to free list
+   MEMORY = memory_alloc_granular(PARTITION_SIZE, OPTIONS.policy, OPTIONS.flags, OPTIONS.granularity);
+   MEMORY->compact_threshold = OPTIONS.threshold;
+   stats_init(&STATS);
+
+   if(OPTIONS.sample > 0)
+       stats_print_sample_header(OPTIONS.csv);
                                    
-   for(i = 0; i < N; i++) // loop through all the input data and simulate a memory management policy
+   while(parse_record(INPUT, inputdata)) // loop through all the input data and simulate a memory management policy
    {
-       printf("************************\n");
-       if(inputdata[i][0] != -99999 && inputdata[i][0] > 0) {
-             printf("ALLOCATE: %d FROM PID: %d\n", inputdata[i][1], inputdata[i][0]);
-             allocate_memory(FREE_LIST, ALLOC_LIST, inputdata[i][0], inputdata[i][1], Memory_Mgt_Policy);
-       }
-       else if (inputdata[i][0] != -99999 && inputdata[i][0] < 0) {
-             printf("DEALLOCATE MEM: PID %d\n", abs(inputdata[i][0]));
-             deallocate_memory(ALLOC_LIST, FREE_LIST, abs(inputdata[i][0]), Memory_Mgt_Policy);
+       if(!quiet){
+           printf("************************\n");
+           if(inputdata[0] != -99999 && inputdata[0] > 0)
+               printf("ALLOCATE: %d FROM PID: %d\n", inputdata[1], inputdata[0]);
+           else if (inputdata[0] != -99999 && inputdata[0] < 0)
+               printf("DEALLOCATE MEM: PID %d\n", abs(inputdata[0]));
+           else
+               printf("COALESCE/COMPACT\n");
        }
-       else {
-             printf("COALESCE/COMPACT\n");
-             FREE_LIST = coalese_memory(FREE_LIST);
-       }   
+
+       stats_apply(&STATS, MEMORY, inputdata, (OPTIONS.flags & MEMORY_COMPACT) != 0);
      
-       printf("************************\n");
-       print_list(FREE_LIST, "Free Memory");
-       print_list(ALLOC_LIST,"\nAllocated Memory");
-       printf("\n\n");
+       if(!quiet){
+           printf("************************\n");
+           memory_print(MEMORY);
+           printf("\n\n");
+       }
+
+       if(OPTIONS.sample > 0 && STATS.records % OPTIONS.sample == 0)
+           stats_print_sample(&STATS, MEMORY, OPTIONS.csv);
+   }
+
+   if(OPTIONS.csv){
+       if(OPTIONS.sample > 0)
+           printf("\n");
+       stats_print_csv_header();
+       snprintf(NAME, sizeof(NAME), "%s%s%s%s", argv[2] + 1,
+                (OPTIONS.flags & MEMORY_EAGER) ? "-EAGER" : (OPTIONS.flags & MEMORY_INDEXED) ? "-INDEX" : "",
+                (OPTIONS.flags & MEMORY_SLAB) ? "-SLAB" : "",
+                (OPTIONS.flags & MEMORY_COMPACT) ? "-COMPACT" : "");
+       stats_print_csv(&STATS, MEMORY, NAME);
    }
+   // the summary varies from run to run, so the plain output is left as it was
+   else if(OPTIONS.stats || quiet || OPTIONS.sample > 0)
+       stats_print_summary(&STATS, MEMORY);
   
-   list_free(FREE_LIST);
-   list_free(ALLOC_LIST);
+   fclose(INPUT);
+   memory_free(MEMORY);
   
    return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,253 @@
+// paging.c
+//
+// Address translation, TLB and page replacement for vmsim. Frames are
+// numbered 0..nframes-1 and all per-frame state is indexed by that number.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "paging.h"
+
+#define TLB_EMPTY  UINT64_MAX
+#define TLB_KEY(pid, page)  ((uint64_t)(uint32_t)(pid) << 32 | (page))
+
+#define BIT_GET(set, i)    (((set)[(i) >> 6] >> ((i) & 63)) & 1)
+#define BIT_SET(set, i)    ((set)[(i) >> 6] |= 1ULL << ((i) & 63))
+#define BIT_CLEAR(set, i)  ((set)[(i) >> 6] &= ~(1ULL << ((i) & 63)))
+
+pager_t *pager_alloc(int policy, int page_size, int nframes, int tlb_entries, int tlb_ways){
+  pager_t *p = calloc(1, sizeof(pager_t));
+  int words = (nframes + 63) / 64;
+  int i;
+
+  p->policy = policy;
+  p->page_shift = __builtin_ctz(page_size);
+  p->l2_bits = (32 - p->page_shift) / 2;
+
+  p->tlb.ways = tlb_ways;
+  p->tlb.sets = tlb_entries / tlb_ways;
+  p->tlb.key = malloc(tlb_entries * sizeof(uint64_t));
+  p->tlb.frame = malloc(tlb_entries * sizeof(int));
+  p->tlb.stamp = calloc(tlb_entries, sizeof(uint64_t));
+  for(i = 0; i < tlb_entries; i++)
+    p->tlb.key[i] = TLB_EMPTY;
+
+  p->nframes = nframes;
+  p->frame_pid = malloc(nframes * sizeof(int));
+  p->frame_page = malloc(nframes * sizeof(uint32_t));
+  p->referenced = calloc(words, sizeof(uint64_t));
+  p->dirty = calloc(words, sizeof(uint64_t));
+  p->lru_prev = malloc(nframes * sizeof(int));
+  p->lru_next = malloc(nframes * sizeof(int));
+  p->lru_head = -1;
+  p->lru_tail = -1;
+
+  return p;
+}
+
+void pager_free(pager_t *p){
+  int pid, i;
+
+  for(pid = 0; pid < p->npids; pid++){
+    if(p->page_tables[pid].tables == NULL)
+      continue;
+    for(i = 0; i < 1 << (32 - p->page_shift - p->l2_bits); i++)
+      free(p->page_tables[pid].tables[i]);
+    free(p->page_tables[pid].tables);
+  }
+  free(p->page_tables);
+  free(p->tlb.key);
+  free(p->tlb.frame);
+  free(p->tlb.stamp);
+  free(p->frame_pid);
+  free(p->frame_page);
+  free(p->referenced);
+  free(p->dirty);
+  free(p->lru_prev);
+  free(p->lru_next);
+  free(p);
+}
+
+/* Page table entry of page, which holds the frame number plus one, or 0
+ * when the page is not resident. Missing tables are created. */
+static int *pte(pager_t *p, int pid, uint32_t page){
+  page_table_t *pt;
+  uint32_t top = page >> p->l2_bits;
+  int n;
+
+  if(pid >= p->npids){
+    n = pid + 1 > 2 * p->npids ? pid + 1 : 2 * p->npids;
+    p->page_tables = realloc(p->page_tables, n * sizeof(page_table_t));
+    memset(p->page_tables + p->npids, 0, (n - p->npids) * sizeof(page_table_t));
+    p->npids = n;
+  }
+
+  pt = &p->page_tables[pid];
+  if(pt->tables == NULL)
+    pt->tables = calloc(1 << (32 - p->page_shift - p->l2_bits), sizeof(int *));
+  if(pt->tables[top] == NULL)
+    pt->tables[top] = calloc(1 << p->l2_bits, sizeof(int));
+  return &pt->tables[top][page & ((1u << p->l2_bits) - 1)];
+}
+
+static int tlb_set(tlb_t *t, int pid, uint32_t page){
+  return (int)((page ^ (uint32_t)pid * 0x9e3779b1u) % (uint32_t)t->sets) * t->ways;
+}
+
+static int tlb_lookup(tlb_t *t, int pid, uint32_t page){
+  int base = tlb_set(t, pid, page), i;
+  uint64_t key = TLB_KEY(pid, page);
+
+  for(i = base; i < base + t->ways; i++){
+    if(t->key[i] == key){
+      t->stamp[i] = ++t->clock;
+      return t->frame[i];
+    }
+  }
+  return -1;
+}
+
+static void tlb_insert(tlb_t *t, int pid, uint32_t page, int frame){
+  int base = tlb_set(t, pid, page), victim = base, i;
+
+  for(i = base; i < base + t->ways; i++){
+    if(t->key[i] == TLB_EMPTY){
+      victim = i;
+      break;
+    }
+    if(t->stamp[i] < t->stamp[victim])
+      victim = i;
+  }
+  t->key[victim] = TLB_KEY(pid, page);
+  t->frame[victim] = frame;
+  t->stamp[victim] = ++t->clock;
+}
+
+static void tlb_invalidate(tlb_t *t, int pid, uint32_t page){
+  int base = tlb_set(t, pid, page), i;
+  uint64_t key = TLB_KEY(pid, page);
+
+  for(i = base; i < base + t->ways; i++){
+    if(t->key[i] == key)
+      t->key[i] = TLB_EMPTY;
+  }
+}
+
+static void lru_unlink(pager_t *p, int f){
+  if(p->lru_prev[f] != -1)
+    p->lru_next[p->lru_prev[f]] = p->lru_next[f];
+  else
+    p->lru_head = p->lru_next[f];
+  if(p->lru_next[f] != -1)
+    p->lru_prev[p->lru_next[f]] = p->lru_prev[f];
+  else
+    p->lru_tail = p->lru_prev[f];
+}
+
+static void lru_push_front(pager_t *p, int f){
+  p->lru_prev[f] = -1;
+  p->lru_next[f] = p->lru_head;
+  if(p->lru_head != -1)
+    p->lru_prev[p->lru_head] = f;
+  else
+    p->lru_tail = f;
+  p->lru_head = f;
+}
+
+static int advance(pager_t *p){
+  int f = p->hand;
+
+  p->hand = p->hand + 1 == p->nframes ? 0 : p->hand + 1;
+  return f;
+}
+
+static int select_victim(pager_t *p){
+  int i, pass;
+
+  if(p->policy == PAGE_LRU)
+    return p->lru_tail;
+
+  if(p->policy == PAGE_CLOCK){
+    while(BIT_GET(p->referenced, p->hand)){
+      BIT_CLEAR(p->referenced, p->hand);
+      advance(p);
+    }
+    return advance(p);
+  }
+
+  if(p->policy == PAGE_SECOND_CHANCE){
+    // look for an unreferenced clean page, then for an unreferenced dirty
+    // one while clearing reference bits, and repeat; the second round is
+    // bound to succeed
+    for(pass = 0; pass < 4; pass++){
+      for(i = 0; i < p->nframes; i++){
+        if(!BIT_GET(p->referenced, p->hand) && BIT_GET(p->dirty, p->hand) == (pass & 1))
+          return advance(p);
+        if(pass & 1)
+          BIT_CLEAR(p->referenced, p->hand);
+        advance(p);
+      }
+    }
+  }
+
+  // FIFO: frames are replaced in the order they were loaded, which is
+  // round robin once they are all in use
+  return advance(p);
+}
+
+/* Makes page resident and returns its frame. */
+static int page_fault(pager_t *p, int pid, uint32_t page, int *entry){
+  int f;
+
+  p->faults += 1;
+
+  if(p->used < p->nframes)
+    f = p->used++;
+  else {
+    f = select_victim(p);
+    *pte(p, p->frame_pid[f], p->frame_page[f]) = 0;
+    tlb_invalidate(&p->tlb, p->frame_pid[f], p->frame_page[f]);
+    if(BIT_GET(p->dirty, f))
+      p->writebacks += 1;
+    BIT_CLEAR(p->dirty, f);
+    p->evictions += 1;
+    if(p->policy == PAGE_LRU)
+      lru_unlink(p, f);
+  }
+
+  p->frame_pid[f] = pid;
+  p->frame_page[f] = page;
+  *entry = f + 1;
+  if(p->policy == PAGE_LRU)
+    lru_push_front(p, f);
+  return f;
+}
+
+uint64_t pager_access(pager_t *p, int pid, uint32_t address, int write){
+  uint32_t page = address >> p->page_shift;
+  int f = tlb_lookup(&p->tlb, pid, page);
+  int *entry;
+
+  p->references += 1;
+  if(f != -1)
+    p->tlb_hits += 1;
+  else {
+    entry = pte(p, pid, page);
+    f = *entry != 0 ? *entry - 1 : page_fault(p, pid, page, entry);
+    tlb_insert(&p->tlb, pid, page, f);
+  }
+
+  BIT_SET(p->referenced, f);
+  if(write){
+    BIT_SET(p->dirty, f);
+    p->writes += 1;
+  }
+  if(p->policy == PAGE_LRU && p->lru_head != f){
+    lru_unlink(p, f);
+    lru_push_front(p, f);
+  }
+
+  return (uint64_t)f << p->page_shift | (address & ((1u << p->page_shift) - 1));
+}
@@ -0,0 +1,73 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <stdint.h>
+
+/**
+ * Paged virtual memory for the vmsim simulator.
+ *
+ * Every PID has a two-level page table over a 32-bit address space, built
+ * on demand. Translations go through a set-associative TLB first; a miss
+ * walks the page table and a page that is not resident faults and is loaded
+ * into a physical frame, evicting another page once all frames are in use.
+ * Frame state lives in flat arrays and bitsets, so every reference costs a
+ * constant amount of work whatever the number of frames.
+ */
+
+#define PAGE_FIFO           1
+#define PAGE_LRU            2
+#define PAGE_CLOCK          3   // one reference bit, cleared as the hand passes
+#define PAGE_SECOND_CHANCE  4   // enhanced second chance: prefers clean pages among the unreferenced
+
+typedef struct tlb {
+  int sets;
+  int ways;
+  uint64_t *key;                 // pid << 32 | page number, TLB_EMPTY when unused
+  int *frame;
+  uint64_t *stamp;               // last use, for LRU within a set
+  uint64_t clock;
+}tlb_t;
+
+typedef struct page_table {
+  int **tables;                  // second level tables, NULL until a page in range is touched
+}page_table_t;
+
+typedef struct pager {
+  int policy;
+  int page_shift;
+  int l2_bits;                   // page number bits resolved by the second level
+
+  page_table_t *page_tables;     // indexed by pid
+  int npids;
+
+  tlb_t tlb;
+
+  int nframes;
+  int used;                      // frames handed out so far, they fill up in order
+  int *frame_pid;
+  uint32_t *frame_page;
+  uint64_t *referenced;          // bitsets over frames
+  uint64_t *dirty;
+  int hand;                      // FIFO, clock and second chance victim pointer
+  int *lru_prev;                 // LRU order as a doubly linked list over frame numbers
+  int *lru_next;
+  int lru_head;                  // most recently used
+  int lru_tail;
+
+  long long references;
+  long long writes;
+  long long tlb_hits;
+  long long faults;
+  long long evictions;
+  long long writebacks;          // dirty pages written out on eviction
+}pager_t;
+
+/* page_size must be a power of two; tlb_entries a multiple of tlb_ways. */
+pager_t *pager_alloc(int policy, int page_size, int nframes, int tlb_entries, int tlb_ways);
+void pager_free(pager_t *p);
+
+/* Translates one reference of pid, which must not be negative, and returns
+ * the physical address. */
+uint64_t pager_access(pager_t *p, int pid, uint32_t address, int write);
+
+#endif				// PAGING_H
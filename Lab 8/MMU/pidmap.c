@@ -0,0 +1,88 @@
+// pidmap.c
+//
+// PID to list node hash map with chained buckets.
+
+#include <stdlib.h>
+
+#include "list.h"
+#include "pidmap.h"
+
+#define ENTRY_CHUNK 512
+
+static unsigned int bucket_of(pidmap_t *m, int pid){
+  return ((unsigned int)pid * 2654435761u) & (m->nbuckets - 1);
+}
+
+static void grow(pidmap_t *m){
+  pidmap_entry_t **old = m->buckets, *e, *next;
+  int n = m->nbuckets, i;
+  unsigned int b;
+
+  m->nbuckets *= 2;
+  m->buckets = calloc(m->nbuckets, sizeof(pidmap_entry_t *));
+  for(i = 0; i < n; i++){
+    for(e = old[i]; e != NULL; e = next){
+      next = e->next;
+      b = bucket_of(m, e->pid);
+      e->next = m->buckets[b];
+      m->buckets[b] = e;
+    }
+  }
+  free(old);
+}
+
+pidmap_t *pidmap_alloc(){
+  pidmap_t *m = malloc(sizeof(pidmap_t));
+
+  m->nbuckets = 256;
+  m->count = 0;
+  m->buckets = calloc(m->nbuckets, sizeof(pidmap_entry_t *));
+  m->entries = pool_alloc(sizeof(pidmap_entry_t), ENTRY_CHUNK);
+  return m;
+}
+
+void pidmap_free(pidmap_t *m){
+  pool_free(m->entries);   // every entry of the table
+  free(m->buckets);
+  free(m);
+}
+
+void pidmap_add(pidmap_t *m, int pid, struct node *node){
+  pidmap_entry_t *e;
+  unsigned int b;
+
+  if(m->count >= m->nbuckets)
+    grow(m);
+  e = pool_get(m->entries);
+  e->pid = pid;
+  e->node = node;
+  b = bucket_of(m, pid);
+  e->next = m->buckets[b];
+  m->buckets[b] = e;
+  m->count += 1;
+}
+
+void pidmap_remove(pidmap_t *m, int pid, struct node *node){
+  pidmap_entry_t **link, *e;
+
+  for(link = &m->buckets[bucket_of(m, pid)]; *link != NULL; link = &(*link)->next){
+    if((*link)->node == node){
+      e = *link;
+      *link = e->next;
+      pool_put(m->entries, e);
+      m->count -= 1;
+      return;
+    }
+  }
+}
+
+struct node *pidmap_find(pidmap_t *m, int pid){
+  pidmap_entry_t *e;
+  node_t *found = NULL;
+
+  for(e = m->buckets[bucket_of(m, pid)]; e != NULL; e = e->next){
+    if(e->pid == pid && (found == NULL || e->node->blk->start < found->blk->start))
+      found = e->node;
+  }
+  return found;
+}
@@ -0,0 +1,38 @@
+#ifndef PIDMAP_H
+#define PIDMAP_H
+
+#include "pool.h"
+
+/**
+ * Hash map from PID to the list nodes holding that PID's blocks, for lists
+ * indexed with list_index_by_pid. A PID may hold several blocks, each with
+ * its own entry. Entries are chained per bucket and come from a pool; the
+ * table doubles once there are as many entries as buckets, so finding a
+ * PID costs O(1) on average however many are live.
+ */
+
+struct node;
+
+typedef struct pidmap_entry {
+  int pid;
+  struct node *node;
+  struct pidmap_entry *next;
+}pidmap_entry_t;
+
+typedef struct pidmap {
+  int nbuckets;              // a power of two
+  int count;
+  pidmap_entry_t **buckets;
+  pool_t *entries;
+}pidmap_t;
+
+pidmap_t *pidmap_alloc();
+void pidmap_free(pidmap_t *m);
+
+void pidmap_add(pidmap_t *m, int pid, struct node *node);
+void pidmap_remove(pidmap_t *m, int pid, struct node *node);
+
+/* Node of the lowest addressed block of pid, NULL when pid holds none. */
+struct node *pidmap_find(pidmap_t *m, int pid);
+
+#endif				// PIDMAP_H
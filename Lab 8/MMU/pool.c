@@ -0,0 +1,76 @@
+// pool.c
+//
+// Chunked object pool with a free list.
+
+#include <stdlib.h>
+
+#include "pool.h"
+
+/* strictest alignment of the records kept in pools, max_align_t being C11 */
+typedef union align {
+  long long l;
+  double d;
+  void *p;
+}align_t;
+
+/* room for the chunk header while keeping the objects aligned */
+#define HEADER_SIZE  ((sizeof(pool_chunk_t) + sizeof(align_t) - 1) / sizeof(align_t) * sizeof(align_t))
+
+pool_t *pool_alloc(size_t object_size, int per_chunk){
+  pool_t *p = malloc(sizeof(pool_t));
+
+  if(object_size < sizeof(void *))
+    object_size = sizeof(void *);
+  p->object_size = (object_size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+  p->per_chunk = per_chunk;
+  p->free = NULL;
+  p->chunks = NULL;
+  p->fresh = NULL;
+  p->fresh_left = 0;
+  p->chunk_allocs = 0;
+  p->live = 0;
+  return p;
+}
+
+void pool_free(pool_t *p){
+  pool_chunk_t *c = p->chunks, *next;
+
+  while(c != NULL){
+    next = c->next;
+    free(c);
+    c = next;
+  }
+  free(p);
+}
+
+void *pool_get(pool_t *p){
+  void *object;
+  pool_chunk_t *c;
+
+  p->live += 1;
+  if(p->free != NULL){
+    object = p->free;
+    p->free = *(void **)object;
+    return object;
+  }
+
+  if(p->fresh_left == 0){
+    c = malloc(HEADER_SIZE + p->per_chunk * p->object_size);
+    c->next = p->chunks;
+    p->chunks = c;
+    p->fresh = (char *)c + HEADER_SIZE;
+    p->fresh_left = p->per_chunk;
+    p->chunk_allocs += 1;
+  }
+
+  object = p->fresh;
+  p->fresh += p->object_size;
+  p->fresh_left -= 1;
+  return object;
+}
+
+void pool_put(pool_t *p, void *object){
+  *(void **)object = p->free;
+  p->free = object;
+  p->live -= 1;
+}
@@ -0,0 +1,34 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+/**
+ * Object pool for fixed size records such as block_t and node_t. Objects
+ * are carved out of large chunks and returned objects are kept on a free
+ * list for reuse, so steady state allocation and release never reach
+ * malloc. Everything is released at once by pool_free.
+ */
+
+typedef struct pool_chunk {
+  struct pool_chunk *next;
+}pool_chunk_t;
+
+typedef struct pool {
+  size_t object_size;
+  int per_chunk;           // objects carved from each chunk
+  void *free;              // released objects, linked through their first word
+  pool_chunk_t *chunks;
+  char *fresh;             // next never used object of the newest chunk
+  int fresh_left;
+  long long chunk_allocs;  // malloc calls made by the pool
+  long long live;          // objects handed out and not yet returned
+}pool_t;
+
+pool_t *pool_alloc(size_t object_size, int per_chunk);
+void pool_free(pool_t *p);
+
+void *pool_get(pool_t *p);
+void pool_put(pool_t *p, void *object);
+
+#endif				// POOL_H
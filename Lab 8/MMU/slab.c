@@ -0,0 +1,278 @@
+// slab.c
+//
+// Size class slabs in front of the allocation policies. Objects are found
+// by PID through a chained hash table, so neither a hit nor a free searches
+// a list.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+#include "list.h"
+#include "slab.h"
+
+#define ENTRY_CHUNK 512
+
+static unsigned int bucket_of(slab_cache_t *c, int pid){
+  return ((unsigned int)pid * 2654435761u) & (c->nbuckets - 1);
+}
+
+static void grow_buckets(slab_cache_t *c){
+  slab_entry_t **old = c->buckets, *e, *next;
+  int n = c->nbuckets, i;
+  unsigned int b;
+
+  c->nbuckets *= 2;
+  c->buckets = calloc(c->nbuckets, sizeof(slab_entry_t *));
+  for(i = 0; i < n; i++){
+    for(e = old[i]; e != NULL; e = next){
+      next = e->next;
+      b = bucket_of(c, e->pid);
+      e->next = c->buckets[b];
+      c->buckets[b] = e;
+    }
+  }
+  free(old);
+}
+
+/* unlinks slab from whichever list of its class it is on */
+static void unlink_slab(slab_class_t *k, slab_t *s){
+  if(s->prev != NULL)
+    s->prev->next = s->next;
+  else if(k->partial == s)
+    k->partial = s->next;
+  else if(k->empty == s)
+    k->empty = s->next;
+  else
+    k->full = s->next;
+  if(s->next != NULL)
+    s->next->prev = s->prev;
+  s->prev = NULL;
+  s->next = NULL;
+}
+
+static void push_slab(slab_t **list, slab_t *s){
+  s->prev = NULL;
+  s->next = *list;
+  if(*list != NULL)
+    (*list)->prev = s;
+  *list = s;
+}
+
+/* files slab on the list that matches its free objects */
+static void file_slab(slab_class_t *k, slab_t *s){
+  if(s->nfree == 0)
+    push_slab(&k->full, s);
+  else if(s->nfree == k->objects)
+    push_slab(&k->empty, s);
+  else
+    push_slab(&k->partial, s);
+}
+
+slab_cache_t *slab_alloc(){
+  slab_cache_t *c = calloc(1, sizeof(slab_cache_t));
+
+  memset(c->class_of, -1, sizeof(c->class_of));
+  c->nbuckets = 256;
+  c->buckets = calloc(c->nbuckets, sizeof(slab_entry_t *));
+  c->entry_pool = pool_alloc(sizeof(slab_entry_t), ENTRY_CHUNK);
+  return c;
+}
+
+static void free_slabs(slab_t *s){
+  slab_t *next;
+
+  for(; s != NULL; s = next){
+    next = s->next;
+    free(s->free);
+    free(s->pids);
+    free(s);
+  }
+}
+
+void slab_free(slab_cache_t *c){
+  int i;
+
+  for(i = 0; i < c->nclasses; i++){
+    free_slabs(c->classes[i].partial);
+    free_slabs(c->classes[i].empty);
+    free_slabs(c->classes[i].full);
+  }
+  pool_free(c->entry_pool);   // every entry of the table
+  free(c->buckets);
+  free(c);
+}
+
+int slab_class_for(slab_cache_t *c, int size){
+  slab_class_t *k;
+
+  if(size <= 0 || size > SLAB_MAX_OBJECT){
+    c->fallbacks += 1;
+    return -1;
+  }
+  if(c->class_of[size] != -1)
+    return c->class_of[size];
+
+  c->fallbacks += 1;
+  c->seen[size] += 1;
+  if(c->seen[size] < SLAB_PROMOTE || c->nclasses == SLAB_CLASSES)
+    return -1;
+
+  // the request that promotes a size is the first one served by its class
+  c->fallbacks -= 1;
+  k = &c->classes[c->nclasses];
+  k->size = size;
+  k->objects = SLAB_BYTES / size > SLAB_MIN_OBJECTS ? SLAB_BYTES / size : SLAB_MIN_OBJECTS;
+  c->class_of[size] = c->nclasses;
+  return c->nclasses++;
+}
+
+int slab_get(slab_cache_t *c, int class, int pid){
+  slab_class_t *k = &c->classes[class];
+  slab_t *s = k->partial != NULL ? k->partial : k->empty;
+  slab_entry_t *e;
+  unsigned int b;
+  int index;
+
+  if(s == NULL)
+    return -1;
+
+  index = s->free[--s->nfree];
+  s->pids[index] = pid;
+  if(s->nfree == 0 || s->nfree == k->objects - 1){
+    unlink_slab(k, s);
+    file_slab(k, s);
+  }
+  c->used_bytes += k->size;
+
+  if(c->nentries >= c->nbuckets)
+    grow_buckets(c);
+  e = pool_get(c->entry_pool);
+  e->pid = pid;
+  e->index = index;
+  e->slab = s;
+  b = bucket_of(c, pid);
+  e->next = c->buckets[b];
+  c->buckets[b] = e;
+  c->nentries += 1;
+  return 0;
+}
+
+int slab_chunk_bytes(slab_cache_t *c, int class){
+  return c->classes[class].size * c->classes[class].objects;
+}
+
+int slab_next_pid(slab_cache_t *c){
+  return SLAB_PID(c->next_id);
+}
+
+void slab_grow(slab_cache_t *c, int class){
+  slab_class_t *k = &c->classes[class];
+  slab_t *s = malloc(sizeof(slab_t));
+  int i;
+
+  s->id = c->next_id++;
+  s->class = class;
+  s->nfree = k->objects;
+  s->free = malloc(k->objects * sizeof(int));
+  s->pids = calloc(k->objects, sizeof(int));
+  for(i = 0; i < k->objects; i++)
+    s->free[i] = k->objects - 1 - i;     // lowest address on top
+
+  push_slab(&k->empty, s);
+  k->nslabs += 1;
+  c->nslabs += 1;
+  c->slab_bytes += slab_chunk_bytes(c, class);
+}
+
+int slab_put(slab_cache_t *c, int pid){
+  slab_entry_t **link, *e;
+  slab_class_t *k;
+  slab_t *s;
+
+  for(link = &c->buckets[bucket_of(c, pid)]; *link != NULL; link = &(*link)->next)
+    if((*link)->pid == pid)
+      break;
+  if(*link == NULL)
+    return -1;
+
+  e = *link;
+  *link = e->next;
+  s = e->slab;
+  k = &c->classes[s->class];
+  s->pids[e->index] = 0;
+  s->free[s->nfree++] = e->index;
+  if(s->nfree == 1 || s->nfree == k->objects){
+    unlink_slab(k, s);
+    file_slab(k, s);
+  }
+  c->used_bytes -= k->size;
+  c->nentries -= 1;
+  pool_put(c->entry_pool, e);
+  return 0;
+}
+
+int slab_take_empty(slab_cache_t *c){
+  slab_class_t *k;
+  slab_t *s;
+  int i, pid;
+
+  for(i = 0; i < c->nclasses; i++){
+    k = &c->classes[i];
+    if(k->empty == NULL)
+      continue;
+
+    s = k->empty;
+    unlink_slab(k, s);
+    k->nslabs -= 1;
+    c->nslabs -= 1;
+    c->slab_bytes -= slab_chunk_bytes(c, i);
+    c->slabs_reclaimed += 1;
+    pid = SLAB_PID(s->id);
+    s->next = NULL;
+    free_slabs(s);
+    return pid;
+  }
+  return 0;
+}
+
+static slab_t *find_slab(slab_t *s, int id){
+  for(; s != NULL; s = s->next)
+    if(s->id == id)
+      return s;
+  return NULL;
+}
+
+void slab_print(slab_cache_t *c, list_t *alloclist, char *message){
+  node_t *current;
+  slab_class_t *k;
+  slab_t *s;
+  int i, j, start, n = 0;
+
+  printf("%s:\n", message);
+
+  for(current = alloclist->head; current != NULL; current = current->next){
+    if(current->blk->pid >= 0)
+      continue;
+
+    s = NULL;
+    for(i = 0; i < c->nclasses && s == NULL; i++){
+      k = &c->classes[i];
+      s = find_slab(k->partial, SLAB_ID(current->blk->pid));
+      if(s == NULL)
+        s = find_slab(k->full, SLAB_ID(current->blk->pid));
+    }
+    if(s == NULL)
+      continue;
+
+    k = &c->classes[s->class];
+    for(j = 0; j < k->objects; j++){
+      if(s->pids[j] == 0)
+        continue;
+      start = current->blk->start + j * k->size;
+      printf("Block %d:\t START: %d\t END: %d\t PID: %d\n", n, start, start + k->size - 1, s->pids[j]);
+      n += 1;
+    }
+  }
+}
@@ -0,0 +1,109 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "pool.h"
+#include "list.h"
+
+/**
+ * Slab cache in front of the allocation policies, enabled by MEMORY_SLAB.
+ *
+ * A request size becomes a size class once it has been asked for
+ * SLAB_PROMOTE times. A class is served from slabs, chunks of the partition
+ * that the policy hands out like any other block (to a negative PID, see
+ * SLAB_PID) and that are cut into objects of exactly that size. Each slab
+ * keeps a stack of its free objects and a class keeps its slabs on partial,
+ * empty and full lists, so a request that finds a free object never reaches
+ * the policy's search. Sizes without a class go to the policy as before.
+ *
+ * Empty slabs are kept for reuse; under memory pressure, when a request
+ * fails, they are given back to the policy and the request is retried.
+ */
+
+#define SLAB_MAX_OBJECT  1024    // larger requests are never cached
+#define SLAB_CLASSES     32
+#define SLAB_PROMOTE     8       // requests of one size before it gets a class
+#define SLAB_BYTES       4096    // target slab size
+#define SLAB_MIN_OBJECTS 8
+
+/* PID under which the chunk of slab id sits in ALLOC_LIST, and back */
+#define SLAB_PID(id)     (-((id) + 1))
+#define SLAB_ID(pid)     (-(pid) - 1)
+
+typedef struct slab {
+  int id;
+  int class;
+  int nfree;
+  int *free;                 // stack of free object indexes
+  int *pids;                 // owner of each object, 0 while free
+  struct slab *prev;         // in the partial, empty or full list of the class
+  struct slab *next;
+}slab_t;
+
+typedef struct slab_class {
+  int size;                  // object size in bytes
+  int objects;               // per slab
+  int nslabs;
+  slab_t *partial;           // some objects free, taken first
+  slab_t *empty;             // all objects free
+  slab_t *full;
+}slab_class_t;
+
+typedef struct slab_entry {
+  int pid;
+  int index;
+  slab_t *slab;
+  struct slab_entry *next;
+}slab_entry_t;
+
+typedef struct slab_cache {
+  int seen[SLAB_MAX_OBJECT + 1];       // requests per size, until promoted
+  signed char class_of[SLAB_MAX_OBJECT + 1];  // -1 for sizes without a class
+  int nclasses;
+  slab_class_t classes[SLAB_CLASSES];
+  int next_id;
+  int nslabs;
+  int slab_bytes;            // held by all slabs
+  int used_bytes;            // of which handed out as objects
+  slab_entry_t **buckets;    // PID to object, chained
+  int nbuckets;              // a power of two
+  int nentries;
+  pool_t *entry_pool;
+  long long hits;            // requests served from an existing slab
+  long long refills;         // requests that made a new slab first
+  long long fallbacks;       // requests left to the policy
+  long long reclaims;        // requests that gave idle slabs back
+  long long slabs_reclaimed;
+}slab_cache_t;
+
+slab_cache_t *slab_alloc();
+void slab_free(slab_cache_t *c);
+
+/* Class for a request of size bytes, -1 when it has none. Counts the
+ * request towards promoting its size. */
+int slab_class_for(slab_cache_t *c, int size);
+
+/* Takes a free object of class for pid. Returns 0 on success and -1 when
+ * every slab of the class is full. */
+int slab_get(slab_cache_t *c, int class, int pid);
+
+/* Bytes of the next slab of class, and PID it must be allocated to. */
+int slab_chunk_bytes(slab_cache_t *c, int class);
+int slab_next_pid(slab_cache_t *c);
+
+/* Adds an empty slab to class once its chunk has been allocated to
+ * slab_next_pid. */
+void slab_grow(slab_cache_t *c, int class);
+
+/* Returns the object of pid to its slab. Returns 0 on success and -1 when
+ * pid holds no object. */
+int slab_put(slab_cache_t *c, int pid);
+
+/* Drops one empty slab and returns the PID its chunk was allocated to, for
+ * the caller to free, or 0 when no slab is empty. */
+int slab_take_empty(slab_cache_t *c);
+
+/* Prints the objects in use, slab by slab in the order of their chunks in
+ * alloclist, each slab placed at the address of its chunk. */
+void slab_print(slab_cache_t *c, list_t *alloclist, char *message);
+
+#endif				// SLAB_H
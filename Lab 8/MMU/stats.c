@@ -0,0 +1,145 @@
+// stats.c
+//
+// Replays trace records against a memory_t and keeps the running metrics
+// that mmu prints in its summary and samples.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "util.h"
+#include "memory.h"
+#include "stats.h"
+
+void stats_init(stats_t *s){
+  s->records = 0;
+  s->requests = 0;
+  s->sim_ns = 0;
+  s->alloc_ns = 0;
+  s->slab_hit_ns = 0;
+  s->frag_sum = 0.0;
+  s->frag_peak = 0.0;
+  s->largest_sum = 0;
+  s->largest_min = INT_MAX;
+  s->internal_frag_peak = 0;
+}
+
+void stats_apply(stats_t *s, memory_t *m, int record[2], int compact){
+  long long hits = m->slab != NULL ? m->slab->hits : 0;
+  long long start_ns = now_ns(), elapsed;
+  double frag;
+  int largest;
+
+  if(record[0] != -99999 && record[0] > 0){
+    memory_allocate(m, record[0], record[1]);
+    elapsed = now_ns() - start_ns;
+    s->alloc_ns += elapsed;
+    s->requests += 1;
+    if(m->slab != NULL && m->slab->hits != hits)
+      s->slab_hit_ns += elapsed;
+  }
+  else {
+    if(record[0] != -99999 && record[0] < 0)
+      memory_deallocate(m, abs(record[0]));
+    else if(compact)
+      memory_compact(m);
+    else
+      memory_coalesce(m);
+    elapsed = now_ns() - start_ns;
+  }
+  s->sim_ns += elapsed;
+  s->records += 1;
+
+  frag = memory_external_frag(m);
+  s->frag_sum += frag;
+  if(frag > s->frag_peak)
+    s->frag_peak = frag;
+
+  largest = memory_largest_free(m);
+  s->largest_sum += largest;
+  if(largest < s->largest_min)
+    s->largest_min = largest;
+
+  if(memory_internal_frag(m) > s->internal_frag_peak)
+    s->internal_frag_peak = memory_internal_frag(m);
+}
+
+static double ops_per_sec(stats_t *s){
+  return s->sim_ns > 0 ? s->records * 1e9 / s->sim_ns : 0.0;
+}
+
+static double average(double sum, long long n){
+  return n > 0 ? sum / n : 0.0;
+}
+
+/* Slab hit rate, and the time and search a hit saves against a request that
+ * went through the policy, at the policy's average cost. */
+static void print_slab_summary(stats_t *s, memory_t *m){
+  slab_cache_t *c = m->slab;
+  long long others = s->requests - c->hits;
+  double hit_us = average(s->slab_hit_ns / 1000.0, c->hits);
+  double other_us = average((s->alloc_ns - s->slab_hit_ns) / 1000.0, others);
+  double search = average(m->searched, others + c->refills);
+
+  printf("Slab hits: %lld of %lld requests (%.1f%%), %lld new slabs, %lld left to the policy\n",
+         c->hits, s->requests, 100.0 * average(c->hits, s->requests), c->refills, c->fallbacks);
+  printf("Slabs: %d in %d classes holding %d bytes (%d in use), %lld reclaimed under pressure\n",
+         c->nslabs, c->nclasses, c->slab_bytes, c->used_bytes, c->slabs_reclaimed);
+  printf("Slab hit time: %.3f us vs %.3f us through the policy, saved about %.3f us and %.0f blocks searched\n",
+         hit_us, other_us, other_us > hit_us ? c->hits * (other_us - hit_us) : 0.0, c->hits * search);
+}
+
+void stats_print_sample_header(int csv){
+  if(csv)
+    printf("record,requests,failures,free_bytes,largest_free,external_frag,internal_frag,sim_ms\n");
+  else
+    printf("%12s%12s%10s%12s%14s%10s%10s%12s\n", "record", "requests", "failed", "free", "largest free", "ext frag", "int frag", "sim (ms)");
+}
+
+void stats_print_sample(stats_t *s, memory_t *m, int csv){
+  const char *format = csv ? "%lld,%lld,%d,%d,%d,%.2f,%d,%.3f\n"
+                           : "%12lld%12lld%10d%12d%14d%9.1f%%%10d%12.3f\n";
+
+  printf(format, s->records, s->requests, m->alloc_failures, memory_free_bytes(m),
+         memory_largest_free(m), memory_external_frag(m), memory_internal_frag(m), s->sim_ns / 1e6);
+}
+
+void stats_print_summary(stats_t *s, memory_t *m){
+  printf("************************\n");
+  printf("SUMMARY\n");
+  printf("************************\n");
+  printf("Records: %lld in %.3f ms (%.0f ops/sec)\n", s->records, s->sim_ns / 1e6, ops_per_sec(s));
+  printf("Allocation requests: %lld (%d failed)\n", s->requests, m->alloc_failures);
+  printf("Allocation time: %.3f us (%.3f us per request)\n", s->alloc_ns / 1000.0,
+         average(s->alloc_ns / 1000.0, s->requests));
+  printf("Average search length: %.2f per request\n", average(m->searched, s->requests));
+  if(m->policy == POLICY_BUDDY || m->policy == POLICY_BITMAP)
+    printf("Internal fragmentation: %d bytes (peak %d bytes)\n", memory_internal_frag(m), s->internal_frag_peak);
+  else
+    printf("Internal fragmentation: 0 bytes (blocks are split to the exact size)\n");
+  printf("External fragmentation: %.1f%% (peak %.1f%%, average %.1f%%)\n",
+         memory_external_frag(m), s->frag_peak, average(s->frag_sum, s->records));
+  printf("Largest free block: %d bytes (smallest %d bytes, average %.0f bytes)\n", memory_largest_free(m),
+         s->records > 0 ? s->largest_min : memory_largest_free(m), average(s->largest_sum, s->records));
+  printf("Free memory: %d bytes\n", memory_free_bytes(m));
+  printf("Peak RSS: %ld KB\n", peak_rss_kb());
+  if(m->slab != NULL)
+    print_slab_summary(s, m);
+  if(m->compactions > 0)
+    printf("Compactions: %d (%lld bytes moved)\n", m->compactions, m->bytes_moved);
+}
+
+void stats_print_csv_header(){
+  printf("policy,records,sim_ms,ops_per_sec,requests,failures,avg_search,"
+         "ext_frag,peak_ext_frag,avg_ext_frag,largest_free,min_largest_free,avg_largest_free,"
+         "internal_frag,peak_internal_frag,compactions,bytes_moved\n");
+}
+
+void stats_print_csv(stats_t *s, memory_t *m, const char *name){
+  printf("%s,%lld,%.3f,%.0f,%lld,%d,%.2f,%.2f,%.2f,%.2f,%d,%d,%.0f,%d,%d,%d,%lld\n",
+         name, s->records, s->sim_ns / 1e6, ops_per_sec(s), s->requests, m->alloc_failures,
+         average(m->searched, s->requests), memory_external_frag(m), s->frag_peak,
+         average(s->frag_sum, s->records), memory_largest_free(m),
+         s->records > 0 ? s->largest_min : memory_largest_free(m), average(s->largest_sum, s->records),
+         memory_internal_frag(m), s->internal_frag_peak, m->compactions, m->bytes_moved);
+}
@@ -0,0 +1,42 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+#include "memory.h"
+
+/**
+ * Aggregate metrics of one trace replay. Every record goes through
+ * stats_apply, which times the memory operation and samples the free space
+ * right after it, so a run can be summarised without printing the lists.
+ */
+
+typedef struct stats {
+  long long records;
+  long long requests;        // allocation records
+  long long sim_ns;          // time spent inside the memory operations
+  long long alloc_ns;        // of which allocations
+  long long slab_hit_ns;     // of which allocations served by an existing slab
+  double frag_sum;           // external fragmentation after each record, summed
+  double frag_peak;
+  long long largest_sum;     // largest free block after each record, summed
+  int largest_min;
+  int internal_frag_peak;
+}stats_t;
+
+void stats_init(stats_t *s);
+
+/* Applies one {pid, size} trace record to m and samples the result. A
+ * coalesce record compacts instead when compact is set. */
+void stats_apply(stats_t *s, memory_t *m, int record[2], int compact);
+
+/* One line with the state after the latest record, for periodic sampling. */
+void stats_print_sample_header(int csv);
+void stats_print_sample(stats_t *s, memory_t *m, int csv);
+
+/* Totals of the run, as the SUMMARY block or as a CSV header and row. */
+void stats_print_summary(stats_t *s, memory_t *m);
+void stats_print_csv_header();
+void stats_print_csv(stats_t *s, memory_t *m, const char *name);
+
+#endif				// STATS_H
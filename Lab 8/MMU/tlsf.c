@@ -0,0 +1,291 @@
+// tlsf.c
+//
+// Two-Level Segregated Fit allocator. Both allocate and free touch a fixed
+// number of size classes and neighbours, independent of how many free blocks
+// exist.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "tlsf.h"
+
+#define BLOCKSIZE(b)  ((b)->blk.end - (b)->blk.start + 1)
+#define POOL_CHUNK    512
+
+/* zeroed record from the block pool */
+static tlsf_block_t *new_block(tlsf_t *t){
+  return memset(pool_get(t->blocks), 0, sizeof(tlsf_block_t));
+}
+
+static int fls_index(unsigned int size){
+  return 31 - __builtin_clz(size);
+}
+
+/* size class that a free block of this size is filed under */
+static void mapping_insert(unsigned int size, int *fl, int *sl){
+  int f;
+
+  if(size < TLSF_SL_COUNT){
+    *fl = 0;
+    *sl = size;
+  }
+  else{
+    f = fls_index(size);
+    *fl = f - TLSF_SL_LOG2 + 1;
+    *sl = (size >> (f - TLSF_SL_LOG2)) - TLSF_SL_COUNT;
+  }
+}
+
+/* first size class whose blocks are all at least this size */
+static void mapping_search(unsigned int size, int *fl, int *sl){
+  if(size >= TLSF_SL_COUNT)
+    size += (1u << (fls_index(size) - TLSF_SL_LOG2)) - 1;
+  mapping_insert(size, fl, sl);
+}
+
+static void insert_free_block(tlsf_t *t, tlsf_block_t *b){
+  int fl, sl;
+
+  mapping_insert(BLOCKSIZE(b), &fl, &sl);
+  b->free = 1;
+  b->blk.pid = 0;
+  b->prev_free = NULL;
+  b->next_free = t->classes[fl][sl];
+  if(b->next_free != NULL)
+    b->next_free->prev_free = b;
+  t->classes[fl][sl] = b;
+  t->fl_bitmap |= 1u << fl;
+  t->sl_bitmap[fl] |= 1u << sl;
+  t->free_bytes += BLOCKSIZE(b);
+}
+
+static void remove_free_block(tlsf_t *t, tlsf_block_t *b){
+  int fl, sl;
+
+  mapping_insert(BLOCKSIZE(b), &fl, &sl);
+  if(b->prev_free != NULL)
+    b->prev_free->next_free = b->next_free;
+  else
+    t->classes[fl][sl] = b->next_free;
+  if(b->next_free != NULL)
+    b->next_free->prev_free = b->prev_free;
+
+  if(t->classes[fl][sl] == NULL){
+    t->sl_bitmap[fl] &= ~(1u << sl);
+    if(t->sl_bitmap[fl] == 0)
+      t->fl_bitmap &= ~(1u << fl);
+  }
+  b->free = 0;
+  t->free_bytes -= BLOCKSIZE(b);
+}
+
+static tlsf_block_t *find_suitable_block(tlsf_t *t, int blocksize, long long *searched){
+  int fl, sl;
+  unsigned int sl_map, fl_map;
+  tlsf_block_t *b;
+
+  *searched += 1;
+  mapping_search(blocksize, &fl, &sl);
+  if(fl < TLSF_FL_COUNT){
+    sl_map = sl < TLSF_SL_COUNT ? t->sl_bitmap[fl] & (~0u << sl) : 0;
+    if(sl_map == 0){
+      fl_map = fl + 1 < TLSF_FL_COUNT ? t->fl_bitmap & (~0u << (fl + 1)) : 0;
+      if(fl_map != 0){
+        fl = __builtin_ctz(fl_map);
+        sl_map = t->sl_bitmap[fl];
+      }
+    }
+    if(sl_map != 0)
+      return t->classes[fl][__builtin_ctz(sl_map)];
+  }
+
+  // The rounded up class is empty, but the request's own class may still
+  // hold a block that is large enough. Scan it before giving up.
+  mapping_insert(blocksize, &fl, &sl);
+  for(b = t->classes[fl][sl]; b != NULL; b = b->next_free){
+    *searched += 1;
+    if(BLOCKSIZE(b) >= blocksize)
+      return b;
+  }
+  return NULL;
+}
+
+tlsf_t *tlsf_alloc(int size){
+  tlsf_t *t = calloc(1, sizeof(tlsf_t));
+  tlsf_block_t *b;
+
+  t->blocks = pool_alloc(sizeof(tlsf_block_t), POOL_CHUNK);
+  b = new_block(t);
+
+  b->blk.start = 0;
+  b->blk.end = size - 1;
+  t->first = b;
+  t->size = size;
+  if(size > 0)
+    insert_free_block(t, b);
+
+  return t;
+}
+
+void tlsf_free(tlsf_t *t){
+  // ALLOC_LIST only points into these records, so they are all released here
+  pool_free(t->blocks);
+  free(t);
+}
+
+int tlsf_allocate(tlsf_t *t, list_t *alloclist, int pid, int blocksize, long long *searched){
+  tlsf_block_t *b = blocksize > 0 ? find_suitable_block(t, blocksize, searched) : NULL;
+  tlsf_block_t *rest;
+
+  if(b == NULL){
+    return -1;
+  }
+
+  remove_free_block(t, b);
+
+  // split off the unused tail and give it back to its size class
+  if(BLOCKSIZE(b) > blocksize){
+    rest = new_block(t);
+    rest->blk.start = b->blk.start + blocksize;
+    rest->blk.end = b->blk.end;
+    rest->phys_prev = b;
+    rest->phys_next = b->phys_next;
+    if(b->phys_next != NULL)
+      b->phys_next->phys_prev = rest;
+    b->phys_next = rest;
+    b->blk.end = rest->blk.start - 1;
+    insert_free_block(t, rest);
+  }
+
+  // tlsf_print walks the address chain, so ALLOC_LIST does not have to be
+  // kept sorted and the insert stays O(1)
+  b->blk.pid = pid;
+  list_add_to_front(alloclist, &b->blk);
+  return 0;
+}
+
+int tlsf_deallocate(tlsf_t *t, list_t *alloclist, int pid){
+  tlsf_block_t *b = (tlsf_block_t *)list_remove_by_pid(alloclist, pid), *neighbour;
+
+  if(b == NULL)
+    return -1;
+
+
+  neighbour = b->phys_next;
+  if(neighbour != NULL && neighbour->free){  // absorb the next block
+    remove_free_block(t, neighbour);
+    b->blk.end = neighbour->blk.end;
+    b->phys_next = neighbour->phys_next;
+    if(neighbour->phys_next != NULL)
+      neighbour->phys_next->phys_prev = b;
+    pool_put(t->blocks, neighbour);
+  }
+
+  neighbour = b->phys_prev;
+  if(neighbour != NULL && neighbour->free){  // let the previous block absorb this one
+    remove_free_block(t, neighbour);
+    neighbour->blk.end = b->blk.end;
+    neighbour->phys_next = b->phys_next;
+    if(b->phys_next != NULL)
+      b->phys_next->phys_prev = neighbour;
+    pool_put(t->blocks, b);
+    b = neighbour;
+  }
+
+  insert_free_block(t, b);
+  return 0;
+}
+
+int tlsf_largest_free(tlsf_t *t){
+  int fl, sl, largest = 0;
+  tlsf_block_t *b;
+
+  if(t->fl_bitmap == 0)
+    return 0;
+
+  // the highest non empty class holds the largest block, but its blocks
+  // are not sorted
+  fl = 31 - __builtin_clz(t->fl_bitmap);
+  sl = 31 - __builtin_clz(t->sl_bitmap[fl]);
+  for(b = t->classes[fl][sl]; b != NULL; b = b->next_free){
+    if(BLOCKSIZE(b) > largest)
+      largest = BLOCKSIZE(b);
+  }
+  return largest;
+}
+
+int tlsf_compact(tlsf_t *t){
+  tlsf_block_t *b = t->first, *next, *last = NULL;
+  int start = 0, size, moved = 0;
+
+  t->fl_bitmap = 0;
+  memset(t->sl_bitmap, 0, sizeof(t->sl_bitmap));
+  memset(t->classes, 0, sizeof(t->classes));
+  t->free_bytes = 0;
+  t->first = NULL;
+
+  // the allocated records keep their identity, so ALLOC_LIST stays valid
+  while(b != NULL){
+    next = b->phys_next;
+    if(b->free)
+      pool_put(t->blocks, b);
+    else{
+      size = BLOCKSIZE(b);
+      if(b->blk.start != start)
+        moved += size;
+      b->blk.start = start;
+      b->blk.end = start + size - 1;
+      start += size;
+      b->phys_prev = last;
+      if(last != NULL)
+        last->phys_next = b;
+      else
+        t->first = b;
+      last = b;
+    }
+    b = next;
+  }
+
+  if(start < t->size){
+    b = new_block(t);
+    b->blk.start = start;
+    b->blk.end = t->size - 1;
+    b->phys_prev = last;
+    if(last != NULL)
+      last->phys_next = b;
+    else
+      t->first = b;
+    last = b;
+    insert_free_block(t, b);
+  }
+  if(last != NULL)
+    last->phys_next = NULL;
+
+  return moved;
+}
+
+void tlsf_print(tlsf_t *t, char *message, char *alloc_message){
+  tlsf_block_t *b;
+  int i = 0;
+
+  printf("%s:\n", message);
+
+  for(b = t->first; b != NULL; b = b->phys_next){
+    if(b->free){
+      printf("Block %d:\t START: %d\t END: %d\n", i, b->blk.start, b->blk.end);
+      i += 1;
+    }
+  }
+
+  printf("%s:\n", alloc_message);
+
+  i = 0;
+  for(b = t->first; b != NULL; b = b->phys_next){
+    if(!b->free){
+      printf("Block %d:\t START: %d\t END: %d\t PID: %d\n", i, b->blk.start, b->blk.end, b->blk.pid);
+      i += 1;
+    }
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef TLSF_H
+#define TLSF_H
+
+#include "list.h"
+
+/**
+ * Two-Level Segregated Fit allocator for the -TLSF policy.
+ *
+ * Free blocks are binned by size: the first level is the power of two of the
+ * size and the second level splits that range into TLSF_SL_COUNT linear
+ * classes. One bitmap per level records which classes are non empty, so a
+ * good fit is found with two find-first-set operations. Every block also
+ * links to its address neighbours (the boundary tags), which lets a free
+ * merge with adjacent free blocks immediately.
+ */
+
+#define TLSF_SL_LOG2  4
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2)
+#define TLSF_FL_COUNT (32 - TLSF_SL_LOG2)
+
+typedef struct tlsf_block {
+  block_t blk;                         // first member, so ALLOC_LIST can hold &blk
+  int free;
+  struct tlsf_block *phys_prev;        // block ending right before blk.start
+  struct tlsf_block *phys_next;        // block starting right after blk.end
+  struct tlsf_block *prev_free;        // links inside a size class
+  struct tlsf_block *next_free;
+}tlsf_block_t;
+
+typedef struct tlsf {
+  unsigned int fl_bitmap;
+  unsigned int sl_bitmap[TLSF_FL_COUNT];
+  tlsf_block_t *classes[TLSF_FL_COUNT][TLSF_SL_COUNT];
+  tlsf_block_t *first;                 // lowest addressed block
+  int size;                            // partition size in bytes
+  int free_bytes;                      // total size of the free blocks
+  pool_t *blocks;                      // every tlsf_block_t, free or allocated
+}tlsf_t;
+
+tlsf_t *tlsf_alloc(int size);
+void tlsf_free(tlsf_t *t);
+
+/* Allocates blocksize bytes for pid and records the block in alloclist,
+ * adding the number of size classes and blocks examined to searched.
+ * Returns 0 on success and -1 when no free block is large enough. */
+int tlsf_allocate(tlsf_t *t, list_t *alloclist, int pid, int blocksize, long long *searched);
+
+/* Releases the block held by pid and merges it with free neighbours.
+ * Returns 0 on success and -1 when pid holds no memory. */
+int tlsf_deallocate(tlsf_t *t, list_t *alloclist, int pid);
+
+/* Size of the largest free block, 0 when nothing is free. */
+int tlsf_largest_free(tlsf_t *t);
+
+/* Slides the allocated blocks down to address 0 in their current order and
+ * leaves a single free block above them. Returns the number of bytes moved. */
+int tlsf_compact(tlsf_t *t);
+
+/* Prints the free blocks, then the allocated ones, in ascending address order. */
+void tlsf_print(tlsf_t *t, char *message, char *alloc_message);
+
+#endif				// TLSF_H
@@ -0,0 +1,282 @@
+// trace.c
+//
+// Synthetic request traces for the MMU simulator.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "trace.h"
+
+#define TRACE_MIN_SIZE 16
+#define TRACE_MAX_SIZE 1024
+
+#define COALESCE_PID 99999   // -99999 is the coalesce record, so no block may use it
+
+trace_t *trace_alloc(int partition_size){
+  trace_t *t = malloc(sizeof(trace_t));
+
+  t->partition_size = partition_size;
+  t->n = 0;
+  t->cap = 256;
+  t->ops = malloc(t->cap * sizeof(*t->ops));
+  return t;
+}
+
+void trace_free(trace_t *t){
+  free(t->ops);
+  free(t);
+}
+
+void trace_add(trace_t *t, int pid, int size){
+  if(t->n == t->cap){
+    t->cap *= 2;
+    t->ops = realloc(t->ops, t->cap * sizeof(*t->ops));
+  }
+  t->ops[t->n][0] = pid;
+  t->ops[t->n][1] = size;
+  t->n += 1;
+}
+
+void trace_write(FILE *f, trace_t *t){
+  int i;
+
+  fprintf(f, "%d\n", t->partition_size);
+  for(i = 0; i < t->n; i++)
+    fprintf(f, "%d %d\n", t->ops[i][0], t->ops[i][1]);
+}
+
+static int random_size(unsigned int *seed){
+  return TRACE_MIN_SIZE + rand_r(seed) % (TRACE_MAX_SIZE - TRACE_MIN_SIZE + 1);
+}
+
+trace_t *trace_fragmenting(int holes, int requests, unsigned int *seed){
+  trace_t *t = trace_alloc(0);
+  long long total = 0;
+  int pid, i;
+
+  for(pid = 1; pid <= 2 * holes; pid++){
+    trace_add(t, pid, random_size(seed));
+    total += t->ops[t->n - 1][1];
+  }
+  for(pid = 1; pid <= 2 * holes; pid += 2)
+    trace_add(t, -pid, 0);
+
+  for(i = 0; i < requests; i++){
+    pid = 2 * holes + 1 + i;
+    trace_add(t, pid, random_size(seed));
+    trace_add(t, -pid, 0);
+  }
+
+  // Leave room for the buddy policy, which rounds every block up to a power
+  // of two, and a tail large enough that no request fails even when freed
+  // blocks are never coalesced.
+  t->partition_size = (int)(4 * total) + (requests + 64) * TRACE_MAX_SIZE;
+  return t;
+}
+
+trace_t *trace_churn(int partition_size, int records, int fill_percent, int coalesce_every, unsigned int *seed){
+  trace_t *t = trace_alloc(partition_size);
+  int *live_pid = malloc(records * sizeof(int));
+  int *live_size = malloc(records * sizeof(int));
+  int live = 0, pid = 1, i, size;
+  long long requested = 0;
+
+  while(t->n < records){
+    if(coalesce_every > 0 && t->n % coalesce_every == coalesce_every - 1){
+      trace_add(t, -99999, 0);
+      continue;
+    }
+
+    // mostly small blocks with the occasional large one
+    size = rand_r(seed) % 8 == 0 ? 32 * random_size(seed) : random_size(seed);
+
+    if(live == 0 || (requested + size < partition_size * (long long)fill_percent / 100 && rand_r(seed) % 5 < 3)){
+      trace_add(t, pid, size);
+      live_pid[live] = pid;
+      live_size[live] = size;
+      live += 1;
+      requested += size;
+      pid += pid + 1 == COALESCE_PID ? 2 : 1;
+    }
+    else {
+      i = rand_r(seed) % live;
+      trace_add(t, -live_pid[i], 0);
+      requested -= live_size[i];
+      live -= 1;
+      live_pid[i] = live_pid[live];
+      live_size[i] = live_size[live];
+    }
+  }
+
+  free(live_pid);
+  free(live_size);
+  return t;
+}
+
+workload_t *workload_alloc(int partition_size, int sizes, unsigned int seed){
+  workload_t *w = calloc(1, sizeof(workload_t));
+
+  w->partition_size = partition_size;
+  w->sizes = sizes;
+  w->min_size = 16;
+  w->max_size = 64 * 1024;
+  w->alpha = 1.2;
+  w->mean_lifetime = 1000;
+  w->long_lived_percent = 5;
+  w->fill_percent = 90;
+  w->coalesce_every = 0;
+  w->seed = seed;
+  w->pid = 1;
+  w->cap = 1024;
+  w->heap = malloc(w->cap * sizeof(workload_block_t));
+  return w;
+}
+
+void workload_free(workload_t *w){
+  free(w->heap);
+  free(w);
+}
+
+/* uniform in (0, 1] */
+static double uniform(unsigned int *seed){
+  return (rand_r(seed) + 1.0) / (RAND_MAX + 1.0);
+}
+
+static int uniform_size(unsigned int *seed, int low, int high){
+  return low + rand_r(seed) % (high - low + 1);
+}
+
+static int workload_size(workload_t *w){
+  double size;
+
+  if(w->sizes == TRACE_SIZES_POWERLAW){
+    // inverse transform sampling of a Pareto distribution; the tail past
+    // max_size is folded back by drawing again
+    do
+      size = w->min_size * pow(uniform(&w->seed), -1.0 / w->alpha);
+    while(size > w->max_size);
+    return (int)size;
+  }
+  if(w->sizes == TRACE_SIZES_BIMODAL){
+    if(rand_r(&w->seed) % 10 == 0)
+      return uniform_size(&w->seed, w->max_size / 4, 3 * (w->max_size / 4));
+    return uniform_size(&w->seed, 2 * w->min_size, 6 * w->min_size);
+  }
+  return uniform_size(&w->seed, w->min_size, w->max_size);
+}
+
+static long long workload_lifetime(workload_t *w){
+  double mean = w->mean_lifetime;
+
+  if(rand_r(&w->seed) % 100 < w->long_lived_percent)
+    mean *= 100;
+  // exponential, at least one allocation
+  return 1 + (long long)(-mean * log(uniform(&w->seed)));
+}
+
+static void heap_push(workload_t *w, workload_block_t b){
+  int i = w->live, parent;
+
+  if(w->live == w->cap){
+    w->cap *= 2;
+    w->heap = realloc(w->heap, w->cap * sizeof(workload_block_t));
+  }
+  w->live += 1;
+  for(; i > 0 && w->heap[parent = (i - 1) / 2].death > b.death; i = parent)
+    w->heap[i] = w->heap[parent];
+  w->heap[i] = b;
+}
+
+static workload_block_t heap_pop(workload_t *w){
+  workload_block_t top = w->heap[0], last = w->heap[--w->live];
+  int i = 0, child;
+
+  while((child = 2 * i + 1) < w->live){
+    if(child + 1 < w->live && w->heap[child + 1].death < w->heap[child].death)
+      child += 1;
+    if(last.death <= w->heap[child].death)
+      break;
+    w->heap[i] = w->heap[child];
+    i = child;
+  }
+  w->heap[i] = last;
+  return top;
+}
+
+void workload_next(workload_t *w, int record[2]){
+  long long target = w->partition_size * (long long)w->fill_percent / 100;
+  workload_block_t b;
+
+  w->records += 1;
+  if(w->coalesce_every > 0 && w->records % w->coalesce_every == 0){
+    record[0] = -COALESCE_PID;
+    record[1] = 0;
+    return;
+  }
+
+  if(w->next_size == 0)
+    w->next_size = workload_size(w);
+
+  if(w->live > 0 && (w->heap[0].death <= w->clock || w->requested + w->next_size > target)){
+    b = heap_pop(w);
+    w->requested -= b.size;
+    record[0] = -b.pid;
+    record[1] = 0;
+    return;
+  }
+
+  b.pid = w->pid;
+  b.size = w->next_size;
+  b.death = w->clock + workload_lifetime(w);
+  heap_push(w, b);
+
+  w->pid += w->pid + 1 == COALESCE_PID ? 2 : 1;
+  w->clock += 1;
+  w->requested += b.size;
+  w->next_size = 0;
+  record[0] = b.pid;
+  record[1] = b.size;
+}
+
+refgen_t *refgen_alloc(int processes, int pages, unsigned int seed){
+  refgen_t *r = calloc(1, sizeof(refgen_t));
+  int i;
+
+  r->processes = processes;
+  r->pages = pages;
+  r->page_size = 4096;
+  r->working_set = 32;
+  r->phase = 100000;
+  r->slice = 1000;
+  r->write_percent = 25;
+  r->seed = seed;
+  r->base = malloc(processes * sizeof(int));
+  for(i = 0; i < processes; i++)
+    r->base[i] = rand_r(&r->seed) % pages;
+  return r;
+}
+
+void refgen_free(refgen_t *r){
+  free(r->base);
+  free(r);
+}
+
+void refgen_next(refgen_t *r, int *pid, unsigned int *address, int *write){
+  int page;
+
+  if(r->references % r->slice == 0)
+    r->pid = rand_r(&r->seed) % r->processes;
+  if(r->references % r->phase == 0 && r->references > 0)
+    r->base[r->pid] = rand_r(&r->seed) % r->pages;
+  r->references += 1;
+
+  if(rand_r(&r->seed) % 10 != 0)
+    page = (r->base[r->pid] + rand_r(&r->seed) % r->working_set) % r->pages;
+  else
+    page = rand_r(&r->seed) % r->pages;
+
+  *pid = r->pid;
+  *address = (unsigned int)page * r->page_size + (rand_r(&r->seed) % r->page_size & ~3u);
+  *write = rand_r(&r->seed) % 100 < r->write_percent;
+}
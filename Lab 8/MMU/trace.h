@@ -0,0 +1,121 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * In memory trace of simulator requests, using the same records as the input
+ * files: {pid, size} allocates, {-pid, 0} deallocates and {-99999, 0}
+ * coalesces.
+ */
+
+typedef struct trace {
+  int partition_size;
+  int n;             // number of records
+  int cap;
+  int (*ops)[2];
+}trace_t;
+
+trace_t *trace_alloc(int partition_size);
+void trace_free(trace_t *t);
+
+void trace_add(trace_t *t, int pid, int size);
+
+/* Writes the trace in the input file format read by parse_file. */
+void trace_write(FILE *f, trace_t *t);
+
+/* Allocates 2*holes blocks and frees every other one, leaving holes free
+ * blocks between live ones, then issues requests allocate/free pairs against
+ * that fragmented partition. The first 3*holes records are the setup phase. */
+trace_t *trace_fragmenting(int holes, int requests, unsigned int *seed);
+
+/* Long running mix of allocations and frees that keeps up to fill_percent of
+ * the partition requested, with a coalesce record every coalesce_every
+ * records (0 for none). */
+trace_t *trace_churn(int partition_size, int records, int fill_percent, int coalesce_every, unsigned int *seed);
+
+/**
+ * Workload generator for traces of any length. Records are produced one at a
+ * time by workload_next, so only the live blocks are kept in memory.
+ *
+ * Every allocation draws a size and a lifetime, counted in allocations, and
+ * is freed once that many later allocations have been made. Block sizes
+ * follow one of the TRACE_SIZES_* distributions. Most blocks die young, but
+ * long_lived_percent of them live 100 times longer on average. When the
+ * next allocation would push the requested bytes past fill_percent of the
+ * partition, the block closest to its end of life is freed early instead.
+ */
+
+#define TRACE_SIZES_UNIFORM   0   // min_size to max_size, evenly
+#define TRACE_SIZES_POWERLAW  1   // Pareto from min_size, most blocks small, a heavy tail up to max_size
+#define TRACE_SIZES_BIMODAL   2   // small objects around 4*min_size plus 1 in 10 around max_size/2
+
+typedef struct workload_block {
+  long long death;         // allocation count at which the block is freed
+  int pid;
+  int size;
+}workload_block_t;
+
+typedef struct workload {
+  int partition_size;
+  int sizes;               // TRACE_SIZES_*
+  int min_size;
+  int max_size;
+  double alpha;            // power law exponent
+  int mean_lifetime;       // in allocations
+  int long_lived_percent;
+  int fill_percent;
+  int coalesce_every;      // a coalesce record every this many records, 0 for none
+  unsigned int seed;
+
+  long long records;       // emitted so far
+  long long clock;         // allocations so far
+  long long requested;     // bytes held by live blocks
+  int pid;
+  int next_size;           // size of the pending allocation, 0 if not drawn yet
+  int live;                // min-heap of live blocks by death
+  int cap;
+  workload_block_t *heap;
+}workload_t;
+
+/* Creates a generator with the defaults: power law sizes from 16 bytes to
+ * 64 KiB, blocks living 1000 allocations on average, 5% long lived, 90%
+ * fill and no coalesce records. Fields may be changed before the first
+ * workload_next. */
+workload_t *workload_alloc(int partition_size, int sizes, unsigned int seed);
+void workload_free(workload_t *w);
+
+/* Stores the next {pid, size} record in record. */
+void workload_next(workload_t *w, int record[2]);
+
+/**
+ * Address reference generator for vmsim. Each process runs for a time slice
+ * of references before the next one is picked at random. Within a process,
+ * 9 in 10 references fall in a working set of consecutive pages that moves
+ * to a new place every phase, the rest anywhere in its address space.
+ */
+
+typedef struct refgen {
+  int processes;
+  int pages;               // virtual pages per process
+  int page_size;
+  int working_set;         // pages
+  int phase;               // references before a working set moves
+  int slice;               // references before another process runs
+  int write_percent;
+  unsigned int seed;
+
+  long long references;    // emitted so far
+  int pid;                 // running process
+  int *base;               // first page of each process's working set
+}refgen_t;
+
+/* Creates a generator for processes with pages pages of 4 KiB each, a
+ * working set of 32 pages moving every 100000 references, time slices of
+ * 1000 references and 25% writes. Fields may be changed before the first
+ * refgen_next. */
+refgen_t *refgen_alloc(int processes, int pages, unsigned int seed);
+void refgen_free(refgen_t *r);
+
+/* Produces the next reference. */
+void refgen_next(refgen_t *r, int *pid, unsigned int *address, int *write);
+
+#endif				// TRACE_H
@@ -0,0 +1,109 @@
+// tracegen.c
+//
+// Writes a synthetic trace in the mmu input file format.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+void print_usage(){
+  fprintf(stderr, "usage: ./tracegen <free blocks> <requests> [seed]\n");
+  fprintf(stderr, "       ./tracegen -{UNIFORM | POWERLAW | BIMODAL} <partition size> <records> [seed] [mean lifetime] [fill percent]\n");
+  fprintf(stderr, "       ./tracegen -REFS <processes> <pages per process> <references> [seed]\n");
+  fprintf(stderr, "  the first form fragments the partition, then times allocate/free pairs against it\n");
+  fprintf(stderr, "  the second streams a workload of any length with the given block size distribution\n");
+  fprintf(stderr, "  the third streams an address reference trace for vmsim\n");
+}
+
+int write_workload(int argc, char *argv[])
+{
+  workload_t *w;
+  long long records, i;
+  int sizes, record[2];
+
+  if(argc < 4) {
+    print_usage();
+    return 1;
+  }
+
+  if(strcmp(argv[1], "-UNIFORM") == 0)
+    sizes = TRACE_SIZES_UNIFORM;
+  else if(strcmp(argv[1], "-POWERLAW") == 0)
+    sizes = TRACE_SIZES_POWERLAW;
+  else if(strcmp(argv[1], "-BIMODAL") == 0)
+    sizes = TRACE_SIZES_BIMODAL;
+  else {
+    print_usage();
+    return 1;
+  }
+
+  w = workload_alloc(atoi(argv[2]), sizes, argc > 4 ? atoi(argv[4]) : 1);
+  records = atoll(argv[3]);
+  if(argc > 5)
+    w->mean_lifetime = atoi(argv[5]);
+  if(argc > 6)
+    w->fill_percent = atoi(argv[6]);
+
+  printf("%d\n", w->partition_size);
+  for(i = 0; i < records; i++){
+    workload_next(w, record);
+    printf("%d %d\n", record[0], record[1]);
+  }
+
+  workload_free(w);
+  return 0;
+}
+
+int write_references(int argc, char *argv[])
+{
+  refgen_t *r;
+  long long references, i;
+  unsigned int address;
+  int pid, write;
+
+  if(argc < 5) {
+    print_usage();
+    return 1;
+  }
+
+  r = refgen_alloc(atoi(argv[2]), atoi(argv[3]), argc > 5 ? atoi(argv[5]) : 1);
+  references = atoll(argv[4]);
+
+  for(i = 0; i < references; i++){
+    refgen_next(r, &pid, &address, &write);
+    printf("%d 0x%x %c\n", pid, address, write ? 'W' : 'R');
+  }
+
+  refgen_free(r);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  int holes, requests;
+  unsigned int seed = 1;
+  trace_t *t;
+
+  if(argc > 1 && strcmp(argv[1], "-REFS") == 0)
+    return write_references(argc, argv);
+  if(argc > 1 && argv[1][0] == '-')
+    return write_workload(argc, argv);
+
+  if(argc < 3) {
+    print_usage();
+    return 1;
+  }
+
+  holes = atoi(argv[1]);
+  requests = atoi(argv[2]);
+  if(argc > 3)
+    seed = atoi(argv[3]);
+
+  t = trace_fragmenting(holes, requests, &seed);
+  trace_write(stdout, t);
+  trace_free(t);
+
+  return 0;
+}
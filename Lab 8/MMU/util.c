@@ -3,34 +3,51 @@
 #include<unistd.h>
 #include<stdlib.h>
 #include<errno.h>
+#include<time.h>
+#include<sys/resource.h>
 
 #include "util.h"
 #include "list.h"
 
 /**
- * Returns an array of process that are parsed from
- * the input file descriptor passed as argument
- * CAUTION: You need to free up the space that is allocated
- * by this function
+ * Reads the partition size from the first line of the input file
  */
-void parse_file(FILE * f, int input[][2], int *n, int *PARTITION_SIZE)
+void parse_partition(FILE * f, int *PARTITION_SIZE)
 {
   
   // get the initial partition sizeof
   
   fscanf(f,"%d\n", PARTITION_SIZE);
-  printf("PARTITION_SIZE = %d\n", *PARTITION_SIZE);
-  
-  while (!feof(f)) {
-		fscanf(f, "%d %d\n", &input[*n][0], &input[*n][1]);
-    /*
-    if(input[*n][0] != -99999 && input[*n][0] > 0)
-        printf("PID=%d ALLOCATE=%dbytes\n", input[*n][0], input[*n][1]);
-    else if (input[*n][0] != -99999 && input[*n][0] < 0)
-        printf("DEALLOCATED PROC = %d\n", abs(input[*n][0]));
-    else
-        printf("COALESCE\n");
-    */
-    *n += 1;
-	}
-}
\ No newline at end of file
+}
+
+/**
+ * Reads the next {pid, size} record of the input file, so a trace of any
+ * length is processed one record at a time.
+ * Returns 1 when a record was read and 0 at the end of the file
+ */
+int parse_record(FILE * f, int record[2])
+{
+  return fscanf(f, "%d %d", &record[0], &record[1]) == 2;
+}
+
+/**
+ * Monotonic clock in nanoseconds, used to time allocation requests
+ */
+long long now_ns()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Largest resident set size of the process so far, in kilobytes
+ */
+long peak_rss_kb()
+{
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
@@ -6,6 +6,9 @@
  */
 
 
-void parse_file(FILE *, int [][2], int *, int *);
+void parse_partition(FILE *, int *);
+int parse_record(FILE *, int [2]);
+long long now_ns();
+long peak_rss_kb();
 
 #endif				// UTIL_H
\ No newline at end of file
@@ -0,0 +1,168 @@
+// vmsim.c
+//
+// Paged virtual memory simulator. Replays an address reference trace, one
+// "<pid> <address> [R | W]" line per reference with the address in decimal
+// or 0x hex, through a TLB, per-PID page tables and a page replacement
+// policy, then prints the hit, fault and writeback counts.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "util.h"
+#include "paging.h"
+
+typedef struct options {
+  int policy;
+  int frames;
+  int page_size;
+  int tlb_entries;
+  int tlb_ways;
+}options_t;
+
+void print_usage(){
+  printf("usage: ./vmsim <reference file | -> -{FIFO | LRU | CLOCK | SECOND} [-FRAMES=<n>] [-PAGESIZE=<bytes>] [-TLB=<entries>] [-WAYS=<n>]\n");
+  printf("  -FRAMES    physical frames (default 1024)\n");
+  printf("  -PAGESIZE  power of two (default 4096)\n");
+  printf("  -TLB       TLB entries (default 64), -WAYS per set (default 4)\n");
+  printf("  SECOND is enhanced second chance, which also looks at the dirty bit\n");
+}
+
+void get_options(int argc, char *args[], options_t *opt){
+  int i, j;
+
+  for(i = 2; i < argc; i++)
+    for(j = 0; args[i][j] != '\0'; j++)
+      args[i][j] = toupper(args[i][j]);
+
+  if(strcmp(args[2], "-FIFO") == 0)
+    opt->policy = PAGE_FIFO;
+  else if(strcmp(args[2], "-LRU") == 0)
+    opt->policy = PAGE_LRU;
+  else if(strcmp(args[2], "-CLOCK") == 0)
+    opt->policy = PAGE_CLOCK;
+  else if(strcmp(args[2], "-SECOND") == 0)
+    opt->policy = PAGE_SECOND_CHANCE;
+  else {
+    print_usage();
+    exit(1);
+  }
+
+  opt->frames = 1024;
+  opt->page_size = 4096;
+  opt->tlb_entries = 64;
+  opt->tlb_ways = 4;
+  for(i = 3; i < argc; i++){
+    if(sscanf(args[i], "-FRAMES=%d", &opt->frames) == 1 && opt->frames > 0)
+      continue;
+    else if(sscanf(args[i], "-PAGESIZE=%d", &opt->page_size) == 1 && opt->page_size >= 16
+            && (opt->page_size & (opt->page_size - 1)) == 0)
+      continue;
+    else if(sscanf(args[i], "-TLB=%d", &opt->tlb_entries) == 1 && opt->tlb_entries > 0)
+      continue;
+    else if(sscanf(args[i], "-WAYS=%d", &opt->tlb_ways) == 1 && opt->tlb_ways > 0)
+      continue;
+    else {
+      print_usage();
+      exit(1);
+    }
+  }
+
+  if(opt->tlb_entries % opt->tlb_ways != 0){
+    print_usage();
+    exit(1);
+  }
+}
+
+/* Reads the next reference. Parsing by hand keeps the reader from costing
+ * more than the simulation on traces of hundreds of millions of lines.
+ * Returns 1 when a reference was read and 0 at the end of the file. */
+int read_reference(FILE *f, int *pid, uint32_t *address, int *write){
+  int c, base;
+  uint32_t value;
+
+  do
+    c = getc_unlocked(f);
+  while(c != EOF && isspace(c));
+  if(c == EOF)
+    return 0;
+
+  for(*pid = 0; isdigit(c); c = getc_unlocked(f))
+    *pid = *pid * 10 + c - '0';
+
+  while(c == ' ' || c == '\t')
+    c = getc_unlocked(f);
+  base = 10;
+  if(c == '0'){
+    c = getc_unlocked(f);
+    if(c == 'x' || c == 'X'){
+      base = 16;
+      c = getc_unlocked(f);
+    }
+  }
+  for(value = 0; isxdigit(c) && (base == 16 || isdigit(c)); c = getc_unlocked(f))
+    value = value * base + (isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+  *address = value;
+
+  while(c == ' ' || c == '\t')
+    c = getc_unlocked(f);
+  *write = c == 'W' || c == 'w';
+  while(c != EOF && c != '\n')
+    c = getc_unlocked(f);
+
+  return 1;
+}
+
+double percent(long long part, long long whole){
+  return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+  options_t OPTIONS;
+  pager_t *PAGER;
+  FILE *INPUT;
+  uint32_t address;
+  int pid, write;
+  long long start_ns, run_ns;
+
+  if(argc < 3) {
+    print_usage();
+    exit(1);
+  }
+
+  get_options(argc, argv, &OPTIONS);
+
+  INPUT = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "r");
+  if (!INPUT) {
+    fprintf(stderr, "Error: Invalid filepath\n");
+    exit(0);
+  }
+
+  PAGER = pager_alloc(OPTIONS.policy, OPTIONS.page_size, OPTIONS.frames, OPTIONS.tlb_entries, OPTIONS.tlb_ways);
+
+  start_ns = now_ns();
+  while(read_reference(INPUT, &pid, &address, &write))
+    pager_access(PAGER, pid, address, write);
+  run_ns = now_ns() - start_ns;
+
+  printf("************************\n");
+  printf("SUMMARY\n");
+  printf("************************\n");
+  printf("References: %lld (%lld writes) in %.3f ms (%.0f references/sec, trace reading included)\n",
+         PAGER->references, PAGER->writes, run_ns / 1e6, run_ns > 0 ? PAGER->references * 1e9 / run_ns : 0.0);
+  printf("TLB: %lld hits (%.2f%%), %lld misses, %d entries in %d-way sets\n", PAGER->tlb_hits,
+         percent(PAGER->tlb_hits, PAGER->references), PAGER->references - PAGER->tlb_hits,
+         OPTIONS.tlb_entries, OPTIONS.tlb_ways);
+  printf("Page faults: %lld (%.2f%% of references), %d frames of %d bytes\n", PAGER->faults,
+         percent(PAGER->faults, PAGER->references), OPTIONS.frames, OPTIONS.page_size);
+  printf("Evictions: %lld (%lld dirty pages written back)\n", PAGER->evictions, PAGER->writebacks);
+
+  if(INPUT != stdin)
+    fclose(INPUT);
+  pager_free(PAGER);
+
+  return 0;
+}